@@ -0,0 +1,52 @@
+# rough avr cycle counts per function from avr-objdump -d, see the
+# avr-cycles target in the Makefile
+#
+# every instruction is counted once at its classic avr core cost, branches
+# and skips as not taken. loops and skipped code aren't followed, so this is
+# the cost of running each function's code once through, good for spotting
+# a change that adds work to the step path rather than for exact timing
+BEGIN {
+  OFS = ","
+  print "function", "instructions", "cycles"
+  split("adiw sbiw mul muls mulsu fmul fmuls fmulsu ld ldd st std lds sts " \
+    "push pop rjmp ijmp sbi cbi", two, " ")
+  for (i in two) {
+    cost[two[i]] = 2
+  }
+  split("rcall icall jmp lpm elpm", three, " ")
+  for (i in three) {
+    cost[three[i]] = 3
+  }
+  split("call ret reti", four, " ")
+  for (i in four) {
+    cost[four[i]] = 4
+  }
+}
+
+/^[0-9a-f]+ <.*>:$/ {
+  if (name != "") {
+    print name, count, cycles
+  }
+  name = $2
+  gsub(/[<>:]/, "", name)
+  count = 0
+  cycles = 0
+  next
+}
+
+/^ *[0-9a-f]+:\t/ && name != "" {
+  split($0, field, "\t")
+  op = field[3]
+  sub(/[ \t].*/, "", op)
+  if (op == "" || op == ".word") {
+    next
+  }
+  count++
+  cycles += (op in cost) ? cost[op] : 1
+}
+
+END {
+  if (name != "") {
+    print name, count, cycles
+  }
+}
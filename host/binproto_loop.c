@@ -0,0 +1,185 @@
+// loops the binary protocol back on itself: frames built with the host
+// encoder go through a byte ring into the device side parser, replies come
+// straight back, and the host keeps to the credits they carry
+//
+//   binproto_loop [-p] [-n moves] [-e every]
+//
+// -p  drain the motion queue as soon as it's filled so only the protocol is
+//     measured, otherwise both axes step once per loop like the step timer
+// -n  number of moves to send, default 100000
+// -e  corrupt one byte of every nth frame sent to exercise resends
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "binenc.h"
+#include "binproto.h"
+#include "motion.h"
+#include "ringbuf.h"
+#include "stepper.h"
+#include "wiring.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define NUM_AXES 2
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static uint8_t ports[NUM_AXES];
+static uint8_t ports_ddr[NUM_AXES];
+static stepper_descriptor_t handles[NUM_AXES];
+static ringbuf_t wire;
+
+static binenc_reply_t reply;
+static int got_reply;
+static unsigned long bad_replies;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _onReply(const uint8_t *data, uint8_t len);
+static void _transmit(const uint8_t *frame, uint8_t size, int corrupt);
+static double _now(void);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+int main(int argc, char **argv) {
+  binenc_t enc;
+  int parse_only = 0;
+  unsigned long total = 100000;
+  unsigned long every = 0;
+  unsigned long queued = 0;
+  unsigned long frames = 0;
+  unsigned long resends = 0;
+  unsigned long bytes = 0;
+  uint16_t now_ms = 0;
+  uint8_t credits = MOTION_QUEUE_SIZE;
+  uint8_t in_flight = 0;
+  uint8_t size = 0;
+  uint8_t targets[NUM_AXES];
+  uint8_t axis;
+  int i;
+  double start;
+  double elapsed;
+
+  for (i=1;i<argc;i++) {
+    if (strcmp(argv[i], "-p") == 0) {
+      parse_only = 1;
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      total = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      every = strtoul(argv[++i], NULL, 10);
+    }
+  }
+
+  for (axis=0;axis<NUM_AXES;axis++) {
+    stepper_construct(
+      wiring_stepperAttr(&ports[axis], &ports_ddr[axis]),
+      &handles[axis]
+    );
+    stepper_enable(handles[axis]);
+  }
+  motion_init(handles, NUM_AXES);
+  ringbuf_init(&wire);
+  binproto_init(&wire, _onReply);
+  binenc_init(&enc);
+  srand(1);
+
+  start = _now();
+  while (queued < total || in_flight) {
+    if (!in_flight) {
+      // pack as many short moves as the credits allow, an empty frame just
+      // asks for fresh credits
+      binenc_begin(&enc);
+      while (binenc_getMoves(&enc) < credits
+        && queued + binenc_getMoves(&enc) < total
+      ) {
+        for (axis=0;axis<NUM_AXES;axis++) {
+          targets[axis] = (uint8_t)(rand() % 8);
+        }
+        if (binenc_move(&enc, 0x03, 0, targets) != BINENC_ERR_NONE) {
+          break;
+        }
+      }
+      size = binenc_finish(&enc);
+      in_flight = 1;
+      frames++;
+      bytes += size;
+      _transmit(enc.frame, size, every != 0 && frames % every == 0);
+    }
+
+    // the device main loop
+    binproto_poll();
+    if (parse_only) {
+      motion_init(handles, NUM_AXES);
+    } else {
+      motion_poll(now_ms++);
+      motion_tick();
+      for (axis=0;axis<NUM_AXES;axis++) {
+        stepper_stepEngage(handles[axis]);
+        stepper_stepRelease(handles[axis]);
+      }
+    }
+
+    if (got_reply) {
+      got_reply = 0;
+      credits = reply.credits;
+      if (reply.status == BINPROTO_STATUS_OK
+        && reply.seq == (uint8_t)(enc.seq - 1)
+      ) {
+        queued += binenc_getMoves(&enc);
+        in_flight = 0;
+      } else {
+        resends++;
+        bytes += size;
+        _transmit(enc.frame, size, 0);
+      }
+    }
+  }
+  elapsed = _now() - start;
+
+  printf("moves      %lu\n", queued);
+  printf("frames     %lu\n", frames);
+  printf("resends    %lu\n", resends);
+  printf("bad_acks   %lu\n", bad_replies);
+  printf("bytes      %lu\n", bytes);
+  printf("wall_s     %.6f\n", elapsed);
+  if (elapsed > 0) {
+    printf("moves_s    %.0f\n", queued / elapsed);
+    printf("frames_s   %.0f\n", frames / elapsed);
+  }
+  printf("bytes_move %.2f\n", queued ? (double)bytes / queued : 0.0);
+
+  return 0;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static void _onReply(const uint8_t *data, uint8_t len) {
+  if (binenc_parseReply(data, len, &reply) == BINENC_ERR_NONE) {
+    got_reply = 1;
+  } else {
+    bad_replies++;
+  }
+}
+
+static void _transmit(const uint8_t *frame, uint8_t size, int corrupt) {
+  uint8_t i;
+
+  for (i=0;i<size;i++) {
+    // flip a payload or crc byte, never the sync
+    ringbuf_put(&wire, (corrupt && i == size - 1) ? frame[i] ^ 0x5A : frame[i]);
+  }
+}
+
+static double _now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,140 @@
+// feeds a g-code file (or stdin) through the interpreter the way the uart
+// would, stepping both axes once per simulated tick, and reports throughput
+//
+//   gcode_feed [-p] [-t ticks_per_ms] [file]
+//
+// -p only parses, the motion queue is emptied as soon as it fills so the
+// numbers are the interpreter's own
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gcode.h"
+#include "motion.h"
+#include "ringbuf.h"
+#include "stepper.h"
+#include "wiring.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define NUM_AXES 2
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static uint8_t ports[NUM_AXES];
+static uint8_t ports_ddr[NUM_AXES];
+static stepper_descriptor_t handles[NUM_AXES];
+static ringbuf_t rx;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static double _now(void);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+int main(int argc, char **argv) {
+  FILE *in = stdin;
+  int parse_only = 0;
+  unsigned long ticks_per_ms = 1;
+  unsigned long ticks = 0;
+  unsigned long bytes = 0;
+  uint16_t now_ms = 0;
+  int at_eof = 0;
+  int c;
+  int i;
+  uint8_t axis;
+  double start;
+  double elapsed;
+
+  for (i=1;i<argc;i++) {
+    if (strcmp(argv[i], "-p") == 0) {
+      parse_only = 1;
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      ticks_per_ms = strtoul(argv[++i], NULL, 10);
+    } else if ((in = fopen(argv[i], "r")) == NULL) {
+      perror(argv[i]);
+      return 1;
+    }
+  }
+  if (ticks_per_ms == 0) {
+    ticks_per_ms = 1;
+  }
+
+  for (axis=0;axis<NUM_AXES;axis++) {
+    stepper_construct(
+      wiring_stepperAttr(&ports[axis], &ports_ddr[axis]),
+      &handles[axis]
+    );
+    // programs usually start with M17, but don't hang on ones that don't
+    stepper_enable(handles[axis]);
+  }
+  motion_init(handles, NUM_AXES);
+  ringbuf_init(&rx);
+  gcode_init(&rx);
+
+  start = _now();
+  while (!at_eof || ringbuf_getCount(&rx) > 0 || !motion_isIdle()) {
+    // the uart isr
+    while (!at_eof && ringbuf_getFree(&rx) > 0) {
+      c = getc(in);
+      if (c == EOF) {
+        // finish a last line that has no newline
+        ringbuf_put(&rx, '\n');
+        at_eof = 1;
+      } else {
+        ringbuf_put(&rx, (uint8_t)c);
+        bytes++;
+      }
+    }
+
+    // the main loop
+    gcode_poll();
+    if (parse_only) {
+      motion_init(handles, NUM_AXES);
+    } else {
+      motion_poll(now_ms);
+    }
+
+    // the step timer isr
+    motion_tick();
+    for (axis=0;axis<NUM_AXES;axis++) {
+      stepper_stepEngage(handles[axis]);
+      stepper_stepRelease(handles[axis]);
+    }
+    ticks++;
+    if (ticks % ticks_per_ms == 0) {
+      now_ms++;
+    }
+  }
+  elapsed = _now() - start;
+
+  printf("lines      %u\n", gcode_getLines());
+  printf("errors     %u\n", gcode_getErrors());
+  printf("bytes      %lu\n", bytes);
+  printf("ticks      %lu\n", ticks);
+  if (!parse_only) {
+    printf("machine_ms %lu\n", ticks / ticks_per_ms);
+  }
+  printf("wall_s     %.6f\n", elapsed);
+  if (elapsed > 0) {
+    printf("lines_s    %.0f\n", gcode_getLines() / elapsed);
+    printf("bytes_s    %.0f\n", bytes / elapsed);
+  }
+
+  return gcode_getErrors() != 0;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static double _now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
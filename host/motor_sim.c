@@ -0,0 +1,401 @@
+// runs step profiles through the firmware against a simulated motor and
+// driver and reports whether the motor keeps up
+//
+//   motor_sim [-c] [-s scenario] [-e scenario] [-J inertia] [-T torque]
+//             [-r driver_rate]
+//
+// each scenario clocks stepper_stepEngage()/stepper_stepRelease() from a
+// virtual step timer and records every rising step edge with its time and
+// the dir line. the edges then drive a two phase hybrid stepper model with
+// rotor inertia, a pull-out torque that falls with speed, friction and a
+// driver that ignores pulses faster than its rated step rate
+//
+// each scenario reports the edges sent, the edges the driver dropped, the
+// steps the rotor slipped, the fastest commanded and rotor speeds in
+// steps/s and the time from the first edge until the rotor settles
+//
+// -c prints csv, -s runs one scenario, -e prints that scenario's edges
+// instead of the report. -J, -T and -r override the motor inertia in kg m^2,
+// holding torque in N m and driver step rate limit in Hz
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scurve.h"
+#include "stepper.h"
+#include "wiring.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_EDGES 8192
+#define STEPS_PER_REV 200
+#define SIM_DT 2e-6
+#define SETTLE_S 0.2
+// rotor within this many steps of the command and slower than SETTLE_SPEED
+// steps/s counts as arrived
+#define SETTLE_STEPS 0.1
+#define SETTLE_SPEED 5.0
+#define FIELD_TAU 5e-4
+#define SLIP_HYSTERESIS 0.5
+
+/*******************************************************************************
+* Private Typedefs
+*******************************************************************************/
+typedef enum profile_t {
+  PROFILE_CONSTANT,
+  PROFILE_SCURVE,
+  PROFILE_OSCILLATE
+} profile_t;
+
+// speeds in steps/s. constant moves start at full speed, scurve moves ramp
+// from min_speed to speed, oscillations stroke steps back and forth once
+// per tick with the given turnaround
+typedef struct scenario_t {
+  const char *name;
+  profile_t profile;
+  uint32_t tick_hz;
+  uint16_t steps;
+  uint16_t speed;
+  uint16_t min_speed;
+  uint32_t accel;
+  uint32_t jerk;
+  uint8_t ramp;
+  uint8_t dwell;
+  uint8_t cycles;
+} scenario_t;
+
+typedef struct motor_t {
+  double inertia;
+  double holding_torque;
+  // speed in steps/s at which the available torque has halved, as the
+  // winding inductance stops the current reaching its set point
+  double corner_speed;
+  double friction;
+  // seconds of torque angle lead per step/s of slip against the field
+  double damping;
+  double driver_rate;
+} motor_t;
+
+typedef struct edge_t {
+  double t;
+  int8_t dir;
+  uint8_t step_size;
+} edge_t;
+
+typedef struct result_t {
+  uint32_t edges;
+  uint32_t dropped;
+  long lost;
+  double cmd_speed;
+  double peak_speed;
+  double move_time;
+} result_t;
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static const scenario_t scenarios[] = {
+  {"const-800", PROFILE_CONSTANT, 50000, 400, 800, 0, 0, 0, 0, 0, 0},
+  {"const-2500", PROFILE_CONSTANT, 50000, 400, 2500, 0, 0, 0, 0, 0, 0},
+  {"const-25000", PROFILE_CONSTANT, 50000, 400, 25000, 0, 0, 0, 0, 0, 0},
+  {"scurve-2500", PROFILE_SCURVE, 50000, 800, 2500, 200, 20000, 400000,
+    0, 0, 0},
+  {"scurve-6000", PROFILE_SCURVE, 50000, 2000, 6000, 200, 20000, 400000,
+    0, 0, 0},
+  {"scurve-6000-hard", PROFILE_SCURVE, 50000, 2000, 6000, 200, 400000,
+    40000000, 0, 0, 0},
+  {"scurve-12000", PROFILE_SCURVE, 50000, 4000, 12000, 200, 20000, 400000,
+    0, 0, 0},
+  {"osc-1000-instant", PROFILE_OSCILLATE, 1000, 40, 0, 0, 0, 0, 0, 0, 5},
+  {"osc-1000-ramp-8", PROFILE_OSCILLATE, 1000, 40, 0, 0, 0, 0, 8, 0, 5},
+  {"osc-3000-ramp-8", PROFILE_OSCILLATE, 3000, 40, 0, 0, 0, 0, 8, 0, 5},
+  {"osc-3000-ramp-32", PROFILE_OSCILLATE, 3000, 40, 0, 0, 0, 0, 32, 0, 5},
+  {"osc-3000-ramp-32-dw", PROFILE_OSCILLATE, 3000, 40, 0, 0, 0, 0, 32, 30,
+    5},
+};
+
+#define NUM_SCENARIOS (sizeof(scenarios) / sizeof(scenarios[0]))
+
+// roughly a nema 17 with a small load on the shaft
+static motor_t motor = {1e-5, 0.4, 1500, 0.03, 1.5e-4, 20000};
+
+static uint8_t port;
+static uint8_t port_ddr;
+static stepper_descriptor_t handle;
+static edge_t edges[MAX_EDGES];
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static uint32_t _record(const scenario_t *scenario);
+static void _tick(uint32_t tick, const scenario_t *scenario, uint32_t *n);
+static void _simulate(uint32_t n, result_t *result);
+static double _torque(double speed);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+int main(int argc, char **argv) {
+  const char *only = NULL;
+  const char *dump = NULL;
+  int csv = 0;
+  int found = 0;
+  int i;
+  uint32_t s;
+  uint32_t n;
+  result_t result;
+
+  for (i=1;i<argc;i++) {
+    if (strcmp(argv[i], "-c") == 0) {
+      csv = 1;
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      only = argv[++i];
+    } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      dump = only = argv[++i];
+    } else if (strcmp(argv[i], "-J") == 0 && i + 1 < argc) {
+      motor.inertia = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-T") == 0 && i + 1 < argc) {
+      motor.holding_torque = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      motor.driver_rate = atof(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [-c] [-s scenario] [-e scenario] "
+        "[-J inertia] [-T torque] [-r driver_rate]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (motor.inertia <= 0 || motor.holding_torque <= 0
+    || motor.driver_rate <= 0
+  ) {
+    fprintf(stderr, "motor parameters must be positive\n");
+    return 1;
+  }
+
+  for (s=0;s<NUM_SCENARIOS;s++) {
+    if (only == NULL || strcmp(only, scenarios[s].name) == 0) {
+      found++;
+    }
+  }
+  if (found == 0) {
+    fprintf(stderr, "no scenario %s\n", only);
+    return 1;
+  }
+
+  if (dump == NULL) {
+    if (csv) {
+      printf("scenario,edges,dropped,lost,cmd_steps_s,peak_steps_s,"
+        "move_ms\n");
+    } else {
+      printf("%-20s %6s %7s %6s %11s %12s %9s\n", "scenario", "edges",
+        "dropped", "lost", "cmd_steps_s", "peak_steps_s", "move_ms");
+    }
+  }
+
+  for (s=0;s<NUM_SCENARIOS;s++) {
+    if (only != NULL && strcmp(only, scenarios[s].name) != 0) {
+      continue;
+    }
+
+    n = _record(&scenarios[s]);
+    if (dump != NULL) {
+      printf("t_s,dir,step_size\n");
+      for (i=0;(uint32_t)i<n;i++) {
+        printf("%.7f,%d,%u\n", edges[i].t, edges[i].dir, edges[i].step_size);
+      }
+      return 0;
+    }
+
+    _simulate(n, &result);
+    if (csv) {
+      printf("%s,%u,%u,%ld,%.0f,%.0f,%.2f\n", scenarios[s].name,
+        result.edges, result.dropped, result.lost, result.cmd_speed,
+        result.peak_speed, result.move_time * 1000);
+    } else {
+      printf("%-20s %6u %7u %6ld %11.0f %12.0f %9.2f\n", scenarios[s].name,
+        result.edges, result.dropped, result.lost, result.cmd_speed,
+        result.peak_speed, result.move_time * 1000);
+    }
+  }
+
+  return 0;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+// clocks the scenario through the stepper driver and logs its step edges
+static uint32_t _record(const scenario_t *scenario) {
+  uint32_t n = 0;
+  uint32_t tick = 0;
+  uint32_t wanted = scenario->steps;
+
+  stepper_construct(
+    wiring_stepperAttr(&port, &port_ddr),
+    &handle
+  );
+  stepper_enable(handle);
+  if (scenario->profile == PROFILE_OSCILLATE) {
+    wanted = 2UL * scenario->steps * scenario->cycles;
+    stepper_setMode(handle, STEPPER_MODE_OSCILLATE);
+    stepper_setTurnaround(handle, scenario->ramp, scenario->dwell);
+    stepper_setPos(handle, scenario->steps, 0);
+  } else {
+    // the profile decides when to step, continuous mode just steps
+    stepper_setMode(handle, STEPPER_MODE_CONTINUOUS);
+  }
+  if (wanted > MAX_EDGES) {
+    wanted = MAX_EDGES;
+  }
+
+  while (n < wanted) {
+    _tick(tick, scenario, &n);
+    tick++;
+  }
+
+  stepper_destruct(handle);
+
+  return n;
+}
+
+// one pass of the step timer isr
+static void _tick(uint32_t tick, const scenario_t *scenario, uint32_t *n) {
+  static scurve_t profile;
+  static uint32_t next;
+  scurve_attr_t config;
+  uint8_t step = 1;
+
+  if (scenario->profile == PROFILE_SCURVE) {
+    if (tick == 0) {
+      config.tick_hz = scenario->tick_hz;
+      config.min_speed = scenario->min_speed;
+      config.max_speed = scenario->speed;
+      config.max_accel = scenario->accel;
+      config.max_jerk = scenario->jerk;
+      scurve_plan(&profile, config, scenario->steps);
+      next = 0;
+    }
+    step = (tick == next);
+    if (step) {
+      next += scurve_nextInterval(&profile);
+    }
+  } else if (scenario->profile == PROFILE_CONSTANT) {
+    step = (tick % (scenario->tick_hz / scenario->speed) == 0);
+  }
+
+  if (step) {
+    stepper_stepEngage(handle);
+    if (port & (1 << 2)) {
+      edges[*n].t = (double)tick / scenario->tick_hz;
+      edges[*n].dir = (port & (1 << 0)) ? -1 : 1;
+      edges[*n].step_size = stepper_getStepSize(handle);
+      (*n)++;
+    }
+  }
+  stepper_stepRelease(handle);
+}
+
+// replays the edges into the motor model. positions are in full steps, the
+// driver's commanded position moves a microstep per accepted edge and the
+// rotor is pulled towards it by a torque that repeats every four full steps.
+// the rotor slips a whole electrical cycle, four steps, whenever it falls
+// more than two steps behind, which is how lost steps are counted
+static void _simulate(uint32_t n, result_t *result) {
+  double step_rad = 2 * M_PI / STEPS_PER_REV;
+  double command = 0;
+  double field = 0;
+  double field_speed;
+  double rotor = 0;
+  double speed = 0;
+  double last_edge = -1;
+  double unsettled = 0;
+  double t = 0;
+  double end;
+  double torque;
+  double accel;
+  double next_speed;
+  double min_interval = 0;
+  long cycle = 0;
+  uint32_t i = 0;
+
+  result->edges = n;
+  result->dropped = 0;
+  result->peak_speed = 0;
+  result->cmd_speed = 0;
+  result->move_time = 0;
+  result->lost = 0;
+  if (n == 0) {
+    return;
+  }
+
+  end = edges[n - 1].t + SETTLE_S;
+  while (t < end) {
+    while (i < n && edges[i].t <= t) {
+      // the commanded rate counts every edge sent, dropped or not
+      if (i > 0
+        && (min_interval == 0 || edges[i].t - edges[i - 1].t < min_interval)
+      ) {
+        min_interval = edges[i].t - edges[i - 1].t;
+      }
+      if (last_edge >= 0 && edges[i].t - last_edge < 1 / motor.driver_rate) {
+        result->dropped++;
+      } else {
+        command += edges[i].dir / (double)(1 << edges[i].step_size);
+        last_edge = edges[i].t;
+      }
+      i++;
+    }
+
+    // damping leads the torque angle by the rotor's speed relative to the
+    // field, the commanded position smoothed over FIELD_TAU, so it can never
+    // make more torque than the motor has
+    field_speed = (command - field) / FIELD_TAU;
+    field += field_speed * SIM_DT;
+    torque = _torque(speed) * sin(M_PI / 2 * (command - rotor
+      + motor.damping * (field_speed - speed)));
+    if (speed == 0 && fabs(torque) <= motor.friction) {
+      // static friction holds the rotor
+      accel = 0;
+    } else if (speed > 0 || (speed == 0 && torque > 0)) {
+      accel = (torque - motor.friction) / motor.inertia / step_rad;
+    } else {
+      accel = (torque + motor.friction) / motor.inertia / step_rad;
+    }
+    // stop at zero and let the next pass decide whether it moves off again
+    next_speed = speed + accel * SIM_DT;
+    if (speed != 0 && (next_speed > 0) != (speed > 0)) {
+      next_speed = 0;
+    }
+    speed = next_speed;
+    rotor += speed * SIM_DT;
+
+    // a little hysteresis so a rotor rocking on the edge isn't counted
+    // slipping back and forth
+    while (command - rotor - 4 * cycle > 2 + SLIP_HYSTERESIS) {
+      cycle++;
+      result->lost += 4;
+    }
+    while (command - rotor - 4 * cycle < -2 - SLIP_HYSTERESIS) {
+      cycle--;
+      result->lost += 4;
+    }
+
+    if (fabs(speed) > result->peak_speed) {
+      result->peak_speed = fabs(speed);
+    }
+    if (i < n || fabs(command - rotor - 4 * cycle) > SETTLE_STEPS
+      || fabs(speed) > SETTLE_SPEED
+    ) {
+      unsettled = t;
+    }
+    t += SIM_DT;
+  }
+
+  result->cmd_speed = (min_interval > 0) ? 1 / min_interval : 0;
+  result->move_time = unsettled - edges[0].t;
+}
+
+// available torque falls off with speed, the pull-out curve
+static double _torque(double speed) {
+  return motor.holding_torque / (1 + fabs(speed) / motor.corner_speed);
+}
@@ -0,0 +1,365 @@
+// times the step path of the stepper driver so tick rates can be chosen
+// from numbers rather than guesses
+//
+//   step_bench [-w baseline] [-b baseline] [-t percent]
+//
+// every stepper operation is timed for one and two axes in each mode. the
+// s-curve interval each axis works out per step doesn't touch the steppers,
+// so it is timed once per axis count with mode "-". the report is csv, one
+// row per operation, axis count and mode, giving the fastest
+// nanoseconds per pass over the axes seen in any batch and, on x86, the
+// matching time stamp counter ticks
+//
+// -w saves the report as a baseline. -b compares against a saved baseline
+// and flags every row more than -t percent (default 20) slower than it,
+// exiting 1 if any are, so a change that slows the hot path shows up
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+#include "stepper.h"
+#include "wiring.h"
+#include "scurve.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_AXES 2
+// calls per timed batch, short enough that a NORMAL move never arrives
+#define BATCH 128
+#define BATCHES 2000
+#define MAX_ROWS 64
+#define DEFAULT_PERCENT 20
+// a move long enough that a batch stays inside the jerk limited ramp, where
+// every step has a new speed to divide by
+#define SCURVE_STEPS 4000
+
+/*******************************************************************************
+* Private Typedefs
+*******************************************************************************/
+typedef enum op_t {
+  OP_ENGAGE,
+  OP_RELEASE,
+  OP_TICK,
+  OP_STEP,
+  OP_SET_STEP_SIZE,
+  OP_SET_DIR,
+  // the ops above run on the steppers, this one only on the profile
+  OP_SCURVE,
+  NUM_OPS
+} op_t;
+
+typedef struct row_t {
+  char op[24];
+  unsigned axes;
+  char mode[16];
+  double ns;
+  double tsc;
+} row_t;
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static const char *op_names[NUM_OPS] = {
+  "stepEngage",
+  "stepRelease",
+  "engage+release",
+  "step",
+  "setStepSize",
+  "setDir",
+  "scurveInterval"
+};
+
+static const char *mode_names[] = {"normal", "oscillate", "continuous"};
+
+static uint8_t ports[MAX_AXES];
+static uint8_t ports_ddr[MAX_AXES];
+static stepper_descriptor_t handles[MAX_AXES];
+static scurve_t profiles[MAX_AXES];
+static scurve_attr_t scurve_config;
+
+static row_t rows[MAX_ROWS];
+static unsigned num_rows;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _setup(unsigned axes, stepper_mode_t mode);
+static void _teardown(unsigned axes);
+static void _run(op_t op, unsigned axes, uint8_t phase);
+static void _measure(op_t op, unsigned axes, stepper_mode_t mode);
+static double _now(void);
+static uint64_t _tsc(void);
+static int _save(const char *path);
+static int _compare(const char *path, double percent);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+int main(int argc, char **argv) {
+  const char *write_path = NULL;
+  const char *base_path = NULL;
+  double percent = DEFAULT_PERCENT;
+  unsigned axes;
+  unsigned i;
+  int op;
+  int mode;
+  int status = 0;
+
+  for (i=1;i<(unsigned)argc;i++) {
+    if (strcmp(argv[i], "-w") == 0 && i + 1 < (unsigned)argc) {
+      write_path = argv[++i];
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < (unsigned)argc) {
+      base_path = argv[++i];
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < (unsigned)argc) {
+      percent = atof(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [-w baseline] [-b baseline] [-t percent]\n",
+        argv[0]);
+      return 1;
+    }
+  }
+
+  for (axes=1;axes<=MAX_AXES;axes++) {
+    for (mode=STEPPER_MODE_NORMAL;mode<=STEPPER_MODE_CONTINUOUS;mode++) {
+      for (op=0;op<OP_SCURVE;op++) {
+        _measure((op_t)op, axes, (stepper_mode_t)mode);
+      }
+    }
+    _measure(OP_SCURVE, axes, STEPPER_MODE_NORMAL);
+  }
+
+  printf("op,axes,mode,ns,tsc\n");
+  for (i=0;i<num_rows;i++) {
+    printf("%s,%u,%s,%.2f,%.1f\n", rows[i].op, rows[i].axes, rows[i].mode,
+      rows[i].ns, rows[i].tsc);
+  }
+
+  if (write_path != NULL && _save(write_path) != 0) {
+    status = 1;
+  }
+  if (base_path != NULL && _compare(base_path, percent) != 0) {
+    status = 1;
+  }
+
+  return status;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+// steppers enabled in the given mode with a target far enough away that a
+// batch never reaches it
+static void _setup(unsigned axes, stepper_mode_t mode) {
+  unsigned axis;
+
+  // a 16 MHz avr with the timer prescaled by 8
+  scurve_config.tick_hz = 2000000;
+  scurve_config.min_speed = 100;
+  scurve_config.max_speed = 5000;
+  scurve_config.max_accel = 50000;
+  scurve_config.max_jerk = 2000000;
+
+  for (axis=0;axis<axes;axis++) {
+    stepper_construct(
+      wiring_stepperAttr(&ports[axis], &ports_ddr[axis]),
+      &handles[axis]
+    );
+    stepper_enable(handles[axis]);
+    stepper_setMode(handles[axis], mode);
+    stepper_setBacklash(handles[axis], 2);
+  }
+}
+
+static void _teardown(unsigned axes) {
+  unsigned axis;
+
+  for (axis=0;axis<axes;axis++) {
+    stepper_destruct(handles[axis]);
+  }
+}
+
+// one batch of calls. the target is reset between batches, outside the
+// timing, so every call takes the stepping path rather than the idle one
+static void _run(op_t op, unsigned axes, uint8_t phase) {
+  unsigned axis;
+  unsigned i;
+
+  for (i=0;i<BATCH;i++) {
+    for (axis=0;axis<axes;axis++) {
+      switch (op) {
+        case OP_ENGAGE:
+          stepper_stepEngage(handles[axis]);
+          break;
+        case OP_RELEASE:
+          stepper_stepRelease(handles[axis]);
+          break;
+        case OP_TICK:
+          stepper_stepEngage(handles[axis]);
+          stepper_stepRelease(handles[axis]);
+          break;
+        case OP_STEP:
+          // one call covers every axis
+          if (axis == 0) {
+            stepper_step(handles, (uint8_t)axes);
+          }
+          break;
+        case OP_SET_STEP_SIZE:
+          stepper_setStepSize(
+            handles[axis],
+            (stepper_step_size_t)((i + phase) % 5)
+          );
+          break;
+        case OP_SET_DIR:
+          // every call reverses, the dearer path with backlash to account
+          stepper_setDir(
+            handles[axis],
+            ((i + phase) & 1) ? STEPPER_DIR_REVERSE : STEPPER_DIR_FORWARD
+          );
+          break;
+        case OP_SCURVE:
+          scurve_nextInterval(&profiles[axis]);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+static void _measure(op_t op, unsigned axes, stepper_mode_t mode) {
+  row_t *row;
+  unsigned axis;
+  unsigned b;
+  double start;
+  double ns;
+  double best_ns = 0;
+  uint64_t tsc_start;
+  uint64_t tsc;
+  uint64_t best_tsc = 0;
+
+  if (num_rows >= MAX_ROWS) {
+    return;
+  }
+
+  _setup(axes, mode);
+  for (b=0;b<BATCHES;b++) {
+    for (axis=0;axis<axes;axis++) {
+      stepper_seedPos(handles[axis], 0);
+      stepper_setDir(handles[axis], STEPPER_DIR_FORWARD);
+      stepper_setPos(handles[axis], BATCH + 10, 0);
+      scurve_plan(&profiles[axis], scurve_config, SCURVE_STEPS);
+    }
+
+    start = _now();
+    tsc_start = _tsc();
+    _run(op, axes, (uint8_t)b);
+    tsc = _tsc() - tsc_start;
+    ns = (_now() - start) * 1e9;
+
+    if (b == 0 || ns < best_ns) {
+      best_ns = ns;
+    }
+    if (b == 0 || tsc < best_tsc) {
+      best_tsc = tsc;
+    }
+  }
+  _teardown(axes);
+
+  row = &rows[num_rows++];
+  snprintf(row->op, sizeof(row->op), "%s", op_names[op]);
+  row->axes = axes;
+  snprintf(row->mode, sizeof(row->mode), "%s",
+    (op == OP_SCURVE) ? "-" : mode_names[mode]);
+  row->ns = best_ns / BATCH;
+  row->tsc = (double)best_tsc / BATCH;
+}
+
+static double _now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t _tsc(void) {
+#if HAVE_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static int _save(const char *path) {
+  FILE *out = fopen(path, "w");
+  unsigned i;
+
+  if (out == NULL) {
+    perror(path);
+    return 1;
+  }
+  fprintf(out, "op,axes,mode,ns,tsc\n");
+  for (i=0;i<num_rows;i++) {
+    fprintf(out, "%s,%u,%s,%.2f,%.1f\n", rows[i].op, rows[i].axes,
+      rows[i].mode, rows[i].ns, rows[i].tsc);
+  }
+  fclose(out);
+
+  return 0;
+}
+
+// rows missing from the baseline are reported but don't fail the run
+static int _compare(const char *path, double percent) {
+  FILE *in = fopen(path, "r");
+  char line[128];
+  row_t base;
+  unsigned i;
+  unsigned matched;
+  int slow = 0;
+
+  if (in == NULL) {
+    perror(path);
+    return 1;
+  }
+
+  fprintf(stderr, "budget: %.0f%% over %s\n", percent, path);
+  for (i=0;i<num_rows;i++) {
+    matched = 0;
+    rewind(in);
+    while (fgets(line, sizeof(line), in) != NULL) {
+      if (sscanf(line, "%23[^,],%u,%15[^,],%lf,%lf", base.op, &base.axes,
+          base.mode, &base.ns, &base.tsc) == 5
+        && strcmp(base.op, rows[i].op) == 0
+        && base.axes == rows[i].axes
+        && strcmp(base.mode, rows[i].mode) == 0
+      ) {
+        matched = 1;
+        break;
+      }
+    }
+
+    if (!matched) {
+      fprintf(stderr, "  new  %s,%u,%s\n", rows[i].op, rows[i].axes,
+        rows[i].mode);
+    } else if (rows[i].ns > base.ns * (1 + percent / 100)) {
+      fprintf(stderr, "  SLOW %s,%u,%s %.2f ns vs %.2f ns (+%.0f%%)\n",
+        rows[i].op, rows[i].axes, rows[i].mode, rows[i].ns, base.ns,
+        (rows[i].ns / base.ns - 1) * 100);
+      slow = 1;
+    }
+  }
+  fclose(in);
+
+  if (!slow) {
+    fprintf(stderr, "  all within budget\n");
+  }
+
+  return slow;
+}
@@ -0,0 +1,37 @@
+#include "wiring.h"
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// the host tools have no real pins, each axis gets a fake port with dir on
+// pin 0 then enable, step, ms1, ms2 and ms3
+stepper_attr_t wiring_stepperAttr(uint8_t *port, uint8_t *port_ddr) {
+  stepper_attr_t config;
+  config.dir_port = port;
+  config.dir_port_ddr = port_ddr;
+  config.dir_pin = 0;
+
+  config.enable_port = port;
+  config.enable_port_ddr = port_ddr;
+  config.enable_pin = 1;
+
+  config.step_port = port;
+  config.step_port_ddr = port_ddr;
+  config.step_pin = 2;
+
+  config.ms1_port = port;
+  config.ms1_port_ddr = port_ddr;
+  config.ms1_pin = 3;
+
+  config.ms2_port = port;
+  config.ms2_port_ddr = port_ddr;
+  config.ms2_pin = 4;
+
+  config.ms3_port = port;
+  config.ms3_port_ddr = port_ddr;
+  config.ms3_pin = 5;
+
+  config.speed = 0;
+
+  return config;
+}
@@ -0,0 +1,11 @@
+#ifndef _WIRING_H
+#define _WIRING_H
+
+#include <stdint.h>
+#include "stepper.h"
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+stepper_attr_t wiring_stepperAttr(uint8_t *port, uint8_t *port_ddr);
+
+#endif // _WIRING_H
@@ -0,0 +1,224 @@
+#include "arc.h"
+#include "kinematics.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+// keeps x^2 + y^2 well inside an int32
+#define ARC_MAX_COORD 16000
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static int8_t _sign(int16_t value);
+static uint16_t _distance(arc_t *arc);
+static int32_t _errorAfter(arc_t *arc, int8_t step_x, int8_t step_y);
+static uint32_t _abs32(int32_t value);
+static uint16_t _isqrt(uint32_t value);
+static uint8_t _isIdle(stepper_descriptor_t handle);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+arc_err_t arc_plan(arc_t *arc, arc_attr_t config) {
+  arc_err_t err = ARC_ERR_NONE;
+  int32_t r2;
+  int32_t end_r2;
+
+  if ((config.dir != ARC_DIR_CW && config.dir != ARC_DIR_CCW)
+    || config.start_x > ARC_MAX_COORD || config.start_x < -ARC_MAX_COORD
+    || config.start_y > ARC_MAX_COORD || config.start_y < -ARC_MAX_COORD
+    || config.end_x > ARC_MAX_COORD || config.end_x < -ARC_MAX_COORD
+    || config.end_y > ARC_MAX_COORD || config.end_y < -ARC_MAX_COORD
+  ) {
+    err = ARC_ERR_OPTION_INVALID;
+  } else {
+    r2 = (int32_t)config.start_x * config.start_x
+      + (int32_t)config.start_y * config.start_y;
+    end_r2 = (int32_t)config.end_x * config.end_x
+      + (int32_t)config.end_y * config.end_y;
+    // the end has to be within about half a step of the circle for the path
+    // to pass next to it, (r + 1/2)^2 - r^2 is roughly r
+    if (r2 == 0 || _abs32(end_r2 - r2) > _isqrt((uint32_t)r2)) {
+      err = ARC_ERR_OPTION_INVALID;
+    }
+  }
+
+  if (err == ARC_ERR_NONE) {
+    arc->x = config.start_x;
+    arc->y = config.start_y;
+    arc->end_x = config.end_x;
+    arc->end_y = config.end_y;
+    arc->error = 0;
+    arc->dir = config.dir;
+    arc->done = 0;
+    // a full circle has to get away from the end before it can finish
+    arc->armed = (_distance(arc) != 0);
+  }
+
+  return err;
+}
+
+// works out the next step along the arc, each axis moves by at most one.
+// returns 0 once the end has been reached
+uint8_t arc_nextStep(arc_t *arc, int8_t *step_x, int8_t *step_y) {
+  int8_t dx;
+  int8_t dy;
+  uint32_t best;
+  uint32_t candidate;
+
+  *step_x = 0;
+  *step_y = 0;
+
+  if (!arc->done) {
+    if (arc->armed && _distance(arc) <= 1) {
+      // close enough to land on the end exactly
+      *step_x = (int8_t)(arc->end_x - arc->x);
+      *step_y = (int8_t)(arc->end_y - arc->y);
+    } else {
+      // the tangent is (-y, x) counter clockwise and (y, -x) clockwise, so
+      // the step is one of its axis components or both. take whichever
+      // leaves the point nearest the circle
+      dx = -_sign(arc->y);
+      dy = _sign(arc->x);
+      if (arc->dir == ARC_DIR_CW) {
+        dx = -dx;
+        dy = -dy;
+      }
+
+      best = UINT32_MAX;
+      if (dx != 0) {
+        best = _abs32(_errorAfter(arc, dx, 0));
+        *step_x = dx;
+      }
+      if (dy != 0) {
+        candidate = _abs32(_errorAfter(arc, 0, dy));
+        if (candidate < best) {
+          best = candidate;
+          *step_x = 0;
+          *step_y = dy;
+        }
+      }
+      if (dx != 0 && dy != 0) {
+        candidate = _abs32(_errorAfter(arc, dx, dy));
+        if (candidate < best) {
+          *step_x = dx;
+          *step_y = dy;
+        }
+      }
+    }
+
+    arc->error = _errorAfter(arc, *step_x, *step_y);
+    arc->x += *step_x;
+    arc->y += *step_y;
+    if (!arc->armed && _distance(arc) > 1) {
+      arc->armed = 1;
+    }
+    if (arc->x == arc->end_x && arc->y == arc->end_y) {
+      arc->done = 1;
+    }
+  }
+
+  return (*step_x != 0 || *step_y != 0);
+}
+
+// call from the step timer isr ahead of stepper_stepEngage(), it hands both
+// steppers their next step once they have finished the last one
+arc_err_t arc_tick(
+  arc_t *arc,
+  stepper_descriptor_t handle_x,
+  stepper_descriptor_t handle_y
+) {
+  arc_err_t err = ARC_ERR_NONE;
+  int8_t step_x;
+  int8_t step_y;
+  int16_t axes[2];
+  int16_t motors[2];
+
+  if (stepper_getStatus(handle_x) == STEPPER_STATUS_AVAILABLE
+    || stepper_getStatus(handle_y) == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = ARC_ERR_HANDLE_INVALID;
+  } else if (_isIdle(handle_x) && _isIdle(handle_y)
+    && arc_nextStep(arc, &step_x, &step_y)
+  ) {
+    // on a coupled machine a diagonal step is two steps for one motor
+    axes[0] = step_x;
+    axes[1] = step_y;
+    kinematics_toMotors(axes, motors, 2);
+    stepper_move(handle_x, motors[0]);
+    stepper_move(handle_y, motors[1]);
+  }
+
+  return err;
+}
+
+uint8_t arc_isDone(arc_t *arc) {
+  return arc->done;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static int8_t _sign(int16_t value) {
+  int8_t sign = 0;
+
+  if (value > 0) {
+    sign = 1;
+  } else if (value < 0) {
+    sign = -1;
+  }
+
+  return sign;
+}
+
+// chebyshev distance to the end, the number of steps a straight line needs
+static uint16_t _distance(arc_t *arc) {
+  uint16_t dx = (uint16_t)_abs32(arc->end_x - arc->x);
+  uint16_t dy = (uint16_t)_abs32(arc->end_y - arc->y);
+
+  return (dx > dy) ? dx : dy;
+}
+
+// (x + sx)^2 - x^2 = 2 x sx + 1 when sx is +-1, and the same for y
+static int32_t _errorAfter(arc_t *arc, int8_t step_x, int8_t step_y) {
+  int32_t error = arc->error;
+
+  if (step_x != 0) {
+    error += 2 * (int32_t)arc->x * step_x + 1;
+  }
+  if (step_y != 0) {
+    error += 2 * (int32_t)arc->y * step_y + 1;
+  }
+
+  return error;
+}
+
+static uint32_t _abs32(int32_t value) {
+  return (value < 0) ? (uint32_t)-value : (uint32_t)value;
+}
+
+static uint16_t _isqrt(uint32_t value) {
+  uint32_t root = 0;
+  uint32_t bit = (uint32_t)1 << 30;
+
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return (uint16_t)root;
+}
+
+static uint8_t _isIdle(stepper_descriptor_t handle) {
+  return stepper_getPos(handle) == stepper_getDesiredPos1(handle)
+    && stepper_getBacklashPending(handle) == 0;
+}
@@ -0,0 +1,54 @@
+#ifndef _ARC_H
+#define _ARC_H
+
+#include <stdint.h>
+#include "stepper.h"
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum arc_err_t {
+  ARC_ERR_NONE,
+  ARC_ERR_OPTION_INVALID,
+  ARC_ERR_HANDLE_INVALID
+} arc_err_t;
+
+typedef enum arc_dir_t {
+  ARC_DIR_CW,
+  ARC_DIR_CCW
+} arc_dir_t;
+
+// start and end are relative to the centre, in steps. the end must lie within
+// a step of the circle through start. an end equal to start is a full circle
+typedef struct arc_attr_t {
+  int16_t start_x;
+  int16_t start_y;
+  int16_t end_x;
+  int16_t end_y;
+  arc_dir_t dir;
+} arc_attr_t;
+
+typedef struct arc_t {
+  int16_t x;
+  int16_t y;
+  int16_t end_x;
+  int16_t end_y;
+  // x^2 + y^2 - r^2 at the current point
+  int32_t error;
+  arc_dir_t dir;
+  uint8_t armed;
+  uint8_t done;
+} arc_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+arc_err_t arc_plan(arc_t *arc, arc_attr_t config);
+uint8_t arc_nextStep(arc_t *arc, int8_t *step_x, int8_t *step_y);
+arc_err_t arc_tick(
+  arc_t *arc,
+  stepper_descriptor_t handle_x,
+  stepper_descriptor_t handle_y
+);
+uint8_t arc_isDone(arc_t *arc);
+
+#endif // _ARC_H
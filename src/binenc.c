@@ -0,0 +1,178 @@
+#include "binenc.h"
+#include "crc8.h"
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static binenc_err_t _append(binenc_t *enc, const uint8_t *record, uint8_t size);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+void binenc_init(binenc_t *enc) {
+  enc->seq = 0;
+  binenc_begin(enc);
+}
+
+void binenc_begin(binenc_t *enc) {
+  enc->len = 0;
+  enc->moves = 0;
+}
+
+binenc_err_t binenc_enable(binenc_t *enc, uint8_t axes) {
+  uint8_t record[2] = {BINPROTO_OP_ENABLE, axes};
+
+  return _append(enc, record, sizeof(record));
+}
+
+binenc_err_t binenc_disable(binenc_t *enc, uint8_t axes) {
+  uint8_t record[2] = {BINPROTO_OP_DISABLE, axes};
+
+  return _append(enc, record, sizeof(record));
+}
+
+binenc_err_t binenc_stepSize(binenc_t *enc, uint8_t axis, uint8_t step_size) {
+  uint8_t record[3] = {BINPROTO_OP_STEP_SIZE, axis, step_size};
+
+  return _append(enc, record, sizeof(record));
+}
+
+binenc_err_t binenc_mode(binenc_t *enc, uint8_t axis, uint8_t mode) {
+  uint8_t record[3] = {BINPROTO_OP_MODE, axis, mode};
+
+  return _append(enc, record, sizeof(record));
+}
+
+binenc_err_t binenc_speed(binenc_t *enc, uint8_t axis, uint8_t speed) {
+  uint8_t record[3] = {BINPROTO_OP_SPEED, axis, speed};
+
+  return _append(enc, record, sizeof(record));
+}
+
+binenc_err_t binenc_target(
+  binenc_t *enc,
+  uint8_t axis,
+  uint8_t pos_1,
+  uint8_t pos_2
+) {
+  uint8_t record[4] = {BINPROTO_OP_TARGET, axis, pos_1, pos_2};
+
+  return _append(enc, record, sizeof(record));
+}
+
+// targets holds one position per bit set in axes, lowest axis first
+binenc_err_t binenc_move(
+  binenc_t *enc,
+  uint8_t axes,
+  uint8_t speed,
+  const uint8_t *targets
+) {
+  binenc_err_t err;
+  uint8_t record[3 + 8];
+  uint8_t size = 3;
+  uint8_t i;
+
+  record[0] = BINPROTO_OP_MOVE;
+  record[1] = axes;
+  record[2] = speed;
+  for (i=0;i<8;i++) {
+    if (axes & (1 << i)) {
+      record[size] = targets[size - 3];
+      size++;
+    }
+  }
+
+  err = _append(enc, record, size);
+  if (err == BINENC_ERR_NONE) {
+    enc->moves++;
+  }
+
+  return err;
+}
+
+binenc_err_t binenc_dwell(binenc_t *enc, uint16_t ms) {
+  binenc_err_t err;
+  uint8_t record[3] = {BINPROTO_OP_DWELL, ms & 0xFF, ms >> 8};
+
+  err = _append(enc, record, sizeof(record));
+  if (err == BINENC_ERR_NONE) {
+    enc->moves++;
+  }
+
+  return err;
+}
+
+// seals the open frame under the next sequence number and returns its size
+uint8_t binenc_finish(binenc_t *enc) {
+  uint8_t crc = 0;
+  uint8_t i;
+
+  enc->frame[0] = BINPROTO_SYNC;
+  enc->frame[1] = enc->len;
+  enc->frame[2] = enc->seq;
+  for (i=1;i<BINPROTO_HEADER_SIZE + enc->len;i++) {
+    crc = crc8_update(crc, enc->frame[i]);
+  }
+  enc->frame[BINPROTO_HEADER_SIZE + enc->len] = crc;
+  enc->seq++;
+
+  return BINPROTO_HEADER_SIZE + enc->len + 1;
+}
+
+// queued commands in the open frame, each uses up one credit
+uint8_t binenc_getMoves(binenc_t *enc) {
+  return enc->moves;
+}
+
+binenc_err_t binenc_parseReply(
+  const uint8_t *data,
+  uint8_t len,
+  binenc_reply_t *reply
+) {
+  binenc_err_t err = BINENC_ERR_NONE;
+  uint8_t crc = 0;
+  uint8_t i;
+
+  if (len != BINPROTO_REPLY_SIZE
+    || data[0] != BINPROTO_SYNC
+    || data[1] != BINPROTO_REPLY_SIZE - BINPROTO_HEADER_SIZE - 1
+  ) {
+    err = BINENC_ERR_REPLY_INVALID;
+  } else {
+    for (i=1;i<BINPROTO_REPLY_SIZE - 1;i++) {
+      crc = crc8_update(crc, data[i]);
+    }
+    if (crc != data[BINPROTO_REPLY_SIZE - 1]) {
+      err = BINENC_ERR_REPLY_INVALID;
+    } else {
+      reply->seq = data[2];
+      reply->status = (binproto_status_t)data[3];
+      reply->credits = data[4];
+    }
+  }
+
+  return err;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static binenc_err_t _append(
+  binenc_t *enc,
+  const uint8_t *record,
+  uint8_t size
+) {
+  binenc_err_t err = BINENC_ERR_NONE;
+  uint8_t i;
+
+  if (enc->len + size > BINPROTO_MAX_PAYLOAD) {
+    err = BINENC_ERR_FRAME_FULL;
+  } else {
+    for (i=0;i<size;i++) {
+      enc->frame[BINPROTO_HEADER_SIZE + enc->len + i] = record[i];
+    }
+    enc->len += size;
+  }
+
+  return err;
+}
@@ -0,0 +1,62 @@
+#ifndef _BINENC_H
+#define _BINENC_H
+
+#include <stdint.h>
+#include "binproto.h"
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum binenc_err_t {
+  BINENC_ERR_NONE,
+  BINENC_ERR_FRAME_FULL,
+  BINENC_ERR_REPLY_INVALID
+} binenc_err_t;
+
+// host side frame builder. records are added to the open frame until
+// binenc_finish() seals it, after which frame holds the bytes to send (and
+// resend if the ack goes missing) until binenc_begin() opens the next one
+typedef struct binenc_t {
+  uint8_t frame[BINPROTO_MAX_FRAME];
+  uint8_t len;
+  uint8_t seq;
+  uint8_t moves;
+} binenc_t;
+
+typedef struct binenc_reply_t {
+  uint8_t seq;
+  binproto_status_t status;
+  uint8_t credits;
+} binenc_reply_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+void binenc_init(binenc_t *enc);
+void binenc_begin(binenc_t *enc);
+binenc_err_t binenc_enable(binenc_t *enc, uint8_t axes);
+binenc_err_t binenc_disable(binenc_t *enc, uint8_t axes);
+binenc_err_t binenc_stepSize(binenc_t *enc, uint8_t axis, uint8_t step_size);
+binenc_err_t binenc_mode(binenc_t *enc, uint8_t axis, uint8_t mode);
+binenc_err_t binenc_speed(binenc_t *enc, uint8_t axis, uint8_t speed);
+binenc_err_t binenc_target(
+  binenc_t *enc,
+  uint8_t axis,
+  uint8_t pos_1,
+  uint8_t pos_2
+);
+binenc_err_t binenc_move(
+  binenc_t *enc,
+  uint8_t axes,
+  uint8_t speed,
+  const uint8_t *targets
+);
+binenc_err_t binenc_dwell(binenc_t *enc, uint16_t ms);
+uint8_t binenc_finish(binenc_t *enc);
+uint8_t binenc_getMoves(binenc_t *enc);
+binenc_err_t binenc_parseReply(
+  const uint8_t *data,
+  uint8_t len,
+  binenc_reply_t *reply
+);
+
+#endif // _BINENC_H
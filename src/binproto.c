@@ -0,0 +1,309 @@
+#include "binproto.h"
+#include "motion.h"
+#include "crc8.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPER_POS 199
+
+/*******************************************************************************
+* Private Typedefs
+*******************************************************************************/
+typedef enum binproto_state_t {
+  BINPROTO_STATE_SYNC,
+  BINPROTO_STATE_LEN,
+  BINPROTO_STATE_SEQ,
+  BINPROTO_STATE_PAYLOAD,
+  BINPROTO_STATE_CRC
+} binproto_state_t;
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static ringbuf_t *rx_buf;
+static binproto_send_t send_reply;
+
+static binproto_state_t state;
+static uint8_t payload[BINPROTO_MAX_PAYLOAD];
+static uint8_t len;
+static uint8_t seq;
+static uint8_t received;
+static uint8_t crc;
+
+static uint8_t expected_seq;
+static uint16_t frames;
+static uint16_t errors;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _feed(uint8_t byte);
+static void _handleFrame(void);
+static binproto_status_t _walk(uint8_t execute);
+static binproto_status_t _checkRecord(const uint8_t *record, uint8_t *moves);
+static void _runRecord(const uint8_t *record);
+static void _reply(uint8_t reply_seq, binproto_status_t status);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// motion_init() must already have been called, replies go out through send
+void binproto_init(ringbuf_t *rx, binproto_send_t send) {
+  rx_buf = rx;
+  send_reply = send;
+  state = BINPROTO_STATE_SYNC;
+  expected_seq = 0;
+  frames = 0;
+  errors = 0;
+}
+
+void binproto_poll(void) {
+  uint8_t byte;
+
+  while (ringbuf_get(rx_buf, &byte)) {
+    _feed(byte);
+  }
+}
+
+// size of the record starting at record, which must have at least two bytes,
+// or 0 if the opcode is unknown
+uint8_t binproto_getRecordSize(const uint8_t *record) {
+  uint8_t size = 0;
+  uint8_t axes;
+
+  switch (record[0]) {
+    case BINPROTO_OP_ENABLE:
+    case BINPROTO_OP_DISABLE:
+      size = 2;
+      break;
+    case BINPROTO_OP_STEP_SIZE:
+    case BINPROTO_OP_MODE:
+    case BINPROTO_OP_SPEED:
+    case BINPROTO_OP_DWELL:
+      size = 3;
+      break;
+    case BINPROTO_OP_TARGET:
+      size = 4;
+      break;
+    case BINPROTO_OP_MOVE:
+      size = 3;
+      for (axes=record[1];axes!=0;axes>>=1) {
+        size += axes & 1;
+      }
+      break;
+  }
+
+  return size;
+}
+
+uint16_t binproto_getFrames(void) {
+  return frames;
+}
+
+uint16_t binproto_getErrors(void) {
+  return errors;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static void _feed(uint8_t byte) {
+  if (state == BINPROTO_STATE_SYNC) {
+    if (byte == BINPROTO_SYNC) {
+      crc = 0;
+      state = BINPROTO_STATE_LEN;
+    }
+  } else if (state == BINPROTO_STATE_LEN) {
+    len = byte;
+    crc = crc8_update(crc, byte);
+    // a length that can't be right means this wasn't really a sync byte
+    state = (len > BINPROTO_MAX_PAYLOAD)
+      ? BINPROTO_STATE_SYNC
+      : BINPROTO_STATE_SEQ;
+  } else if (state == BINPROTO_STATE_SEQ) {
+    seq = byte;
+    crc = crc8_update(crc, byte);
+    received = 0;
+    state = (len == 0) ? BINPROTO_STATE_CRC : BINPROTO_STATE_PAYLOAD;
+  } else if (state == BINPROTO_STATE_PAYLOAD) {
+    payload[received++] = byte;
+    crc = crc8_update(crc, byte);
+    if (received == len) {
+      state = BINPROTO_STATE_CRC;
+    }
+  } else {
+    if (byte == crc) {
+      _handleFrame();
+    } else {
+      errors++;
+      _reply(expected_seq, BINPROTO_STATUS_CRC);
+    }
+    state = BINPROTO_STATE_SYNC;
+  }
+}
+
+static void _handleFrame(void) {
+  binproto_status_t status;
+
+  if (seq == (uint8_t)(expected_seq - 1)) {
+    // the host missed our ack and sent the frame again, it already ran
+    status = BINPROTO_STATUS_OK;
+  } else if (seq != expected_seq) {
+    status = BINPROTO_STATUS_SEQUENCE;
+    seq = expected_seq;
+  } else {
+    // check the whole frame first so it runs entirely or not at all
+    status = _walk(0);
+    if (status == BINPROTO_STATUS_OK) {
+      _walk(1);
+      expected_seq++;
+      frames++;
+    }
+  }
+
+  if (status != BINPROTO_STATUS_OK) {
+    errors++;
+  }
+  _reply(seq, status);
+}
+
+static binproto_status_t _walk(uint8_t execute) {
+  binproto_status_t status = BINPROTO_STATUS_OK;
+  uint8_t i = 0;
+  uint8_t size;
+  uint8_t moves = 0;
+
+  while (i < len && status == BINPROTO_STATUS_OK) {
+    size = (len - i >= 2) ? binproto_getRecordSize(&payload[i]) : 0;
+    if (size == 0 || size > len - i) {
+      status = BINPROTO_STATUS_INVALID;
+    } else if (execute) {
+      _runRecord(&payload[i]);
+    } else {
+      status = _checkRecord(&payload[i], &moves);
+    }
+    i += size;
+  }
+
+  if (status == BINPROTO_STATUS_OK && moves > motion_getFree()) {
+    status = BINPROTO_STATUS_FULL;
+  }
+
+  return status;
+}
+
+static binproto_status_t _checkRecord(const uint8_t *record, uint8_t *moves) {
+  binproto_status_t status = BINPROTO_STATUS_OK;
+  uint8_t num_axes = motion_getNumAxes();
+  uint8_t i;
+
+  if (record[0] == BINPROTO_OP_ENABLE || record[0] == BINPROTO_OP_DISABLE) {
+    if (record[1] >= (1 << num_axes)) {
+      status = BINPROTO_STATUS_INVALID;
+    }
+  } else if (record[0] == BINPROTO_OP_MOVE || record[0] == BINPROTO_OP_DWELL) {
+    if (record[0] == BINPROTO_OP_MOVE) {
+      if (record[1] == 0 || record[1] >= (1 << num_axes)) {
+        status = BINPROTO_STATUS_INVALID;
+      }
+      for (i=3;i<binproto_getRecordSize(record);i++) {
+        if (record[i] > MAX_STEPPER_POS) {
+          status = BINPROTO_STATUS_INVALID;
+        }
+      }
+    }
+    (*moves)++;
+  } else if (record[1] >= num_axes) {
+    status = BINPROTO_STATUS_INVALID;
+  } else if (record[0] == BINPROTO_OP_STEP_SIZE) {
+    if (record[2] > STEPPER_STEP_SIZE_SIXTEENTH) {
+      status = BINPROTO_STATUS_INVALID;
+    }
+  } else if (record[0] == BINPROTO_OP_MODE) {
+    if (record[2] > STEPPER_MODE_CONTINUOUS) {
+      status = BINPROTO_STATUS_INVALID;
+    }
+  } else if (record[0] == BINPROTO_OP_TARGET) {
+    if (record[2] > MAX_STEPPER_POS || record[3] > MAX_STEPPER_POS) {
+      status = BINPROTO_STATUS_INVALID;
+    }
+  }
+
+  return status;
+}
+
+// settings take effect as soon as the frame arrives, moves and dwells are
+// queued behind whatever is already running
+static void _runRecord(const uint8_t *record) {
+  motion_cmd_t cmd;
+  uint8_t next = 3;
+  uint8_t i;
+
+  switch (record[0]) {
+    case BINPROTO_OP_ENABLE:
+    case BINPROTO_OP_DISABLE:
+      for (i=0;i<motion_getNumAxes();i++) {
+        if (record[1] & (1 << i)) {
+          if (record[0] == BINPROTO_OP_ENABLE) {
+            stepper_enable(motion_getHandle(i));
+          } else {
+            stepper_disable(motion_getHandle(i));
+          }
+        }
+      }
+      break;
+    case BINPROTO_OP_STEP_SIZE:
+      stepper_setStepSize(
+        motion_getHandle(record[1]),
+        (stepper_step_size_t)record[2]
+      );
+      break;
+    case BINPROTO_OP_MODE:
+      stepper_setMode(motion_getHandle(record[1]), (stepper_mode_t)record[2]);
+      break;
+    case BINPROTO_OP_SPEED:
+      stepper_setSpeed(motion_getHandle(record[1]), record[2]);
+      break;
+    case BINPROTO_OP_TARGET:
+      stepper_setPos(motion_getHandle(record[1]), record[2], record[3]);
+      break;
+    case BINPROTO_OP_MOVE:
+      cmd.op = MOTION_OP_MOVE;
+      cmd.axes = record[1];
+      cmd.speed = record[2];
+      cmd.dwell_ms = 0;
+      for (i=0;i<MOTION_MAX_AXES;i++) {
+        cmd.target[i] = 0;
+        if (cmd.axes & (1 << i)) {
+          cmd.target[i] = record[next++];
+        }
+      }
+      motion_push(&cmd);
+      break;
+    case BINPROTO_OP_DWELL:
+      cmd.op = MOTION_OP_DWELL;
+      cmd.axes = 0;
+      cmd.speed = 0;
+      cmd.dwell_ms = record[1] | ((uint16_t)record[2] << 8);
+      motion_push(&cmd);
+      break;
+  }
+}
+
+static void _reply(uint8_t reply_seq, binproto_status_t status) {
+  uint8_t reply[BINPROTO_REPLY_SIZE];
+  uint8_t i;
+
+  reply[0] = BINPROTO_SYNC;
+  reply[1] = 2;
+  reply[2] = reply_seq;
+  reply[3] = status;
+  reply[4] = motion_getFree();
+  reply[5] = 0;
+  for (i=1;i<BINPROTO_REPLY_SIZE - 1;i++) {
+    reply[5] = crc8_update(reply[5], reply[i]);
+  }
+
+  send_reply(reply, BINPROTO_REPLY_SIZE);
+}
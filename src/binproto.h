@@ -0,0 +1,54 @@
+#ifndef _BINPROTO_H
+#define _BINPROTO_H
+
+#include <stdint.h>
+#include "ringbuf.h"
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+// a frame is SYNC, LEN, SEQ, LEN payload bytes then a crc-8 over LEN, SEQ and
+// the payload. the payload is a run of records, each an opcode and its args
+#define BINPROTO_SYNC 0xA5
+#define BINPROTO_MAX_PAYLOAD 48
+#define BINPROTO_HEADER_SIZE 3
+#define BINPROTO_MAX_FRAME (BINPROTO_HEADER_SIZE + BINPROTO_MAX_PAYLOAD + 1)
+#define BINPROTO_REPLY_SIZE (BINPROTO_HEADER_SIZE + 2 + 1)
+
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+// record layouts, axes is a bit mask and a move carries one target for each
+// bit set, lowest axis first
+typedef enum binproto_op_t {
+  BINPROTO_OP_ENABLE = 1,    // axes
+  BINPROTO_OP_DISABLE,       // axes
+  BINPROTO_OP_STEP_SIZE,     // axis, step_size
+  BINPROTO_OP_MODE,          // axis, mode
+  BINPROTO_OP_SPEED,         // axis, speed
+  BINPROTO_OP_TARGET,        // axis, pos_1, pos_2
+  BINPROTO_OP_MOVE,          // axes, speed, targets...
+  BINPROTO_OP_DWELL          // ms low byte, ms high byte
+} binproto_op_t;
+
+// every frame is answered with SEQ, status and the number of moves the
+// motion queue can still take
+typedef enum binproto_status_t {
+  BINPROTO_STATUS_OK,
+  BINPROTO_STATUS_CRC,
+  BINPROTO_STATUS_SEQUENCE,
+  BINPROTO_STATUS_INVALID,
+  BINPROTO_STATUS_FULL
+} binproto_status_t;
+
+typedef void (*binproto_send_t)(const uint8_t *data, uint8_t len);
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+void binproto_init(ringbuf_t *rx, binproto_send_t send);
+void binproto_poll(void);
+uint8_t binproto_getRecordSize(const uint8_t *record);
+uint16_t binproto_getFrames(void);
+uint16_t binproto_getErrors(void);
+
+#endif // _BINPROTO_H
@@ -0,0 +1,25 @@
+#include "crc8.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define CRC8_POLY 0x07
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// crc-8 with polynomial x^8 + x^2 + x + 1, start from 0
+uint8_t crc8_update(uint8_t crc, uint8_t byte) {
+  uint8_t bit;
+
+  crc ^= byte;
+  for (bit=0;bit<8;bit++) {
+    if (crc & 0x80) {
+      crc = (uint8_t)(crc << 1) ^ CRC8_POLY;
+    } else {
+      crc <<= 1;
+    }
+  }
+
+  return crc;
+}
@@ -0,0 +1,10 @@
+#ifndef _CRC8_H
+#define _CRC8_H
+
+#include <stdint.h>
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+uint8_t crc8_update(uint8_t crc, uint8_t byte);
+
+#endif // _CRC8_H
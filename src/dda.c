@@ -0,0 +1,90 @@
+#include "dda.h"
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// the level is the highest that still leaves at least a tick per event, so
+// the work done on any one tick doesn't grow however slow the segment is
+dda_err_t dda_plan(dda_t *dda, dda_attr_t config) {
+  dda_err_t err = DDA_ERR_NONE;
+  uint16_t most = 0;
+  uint8_t i;
+
+  if (config.num_axes == 0
+    || config.num_axes > DDA_MAX_AXES
+    || config.interval == 0
+    || config.max_level > DDA_MAX_LEVEL
+  ) {
+    err = DDA_ERR_OPTION_INVALID;
+  } else {
+    dda->num_axes = config.num_axes;
+    for (i=0;i<config.num_axes;i++) {
+      dda->dir[i] = (config.steps[i] < 0) ? -1 : 1;
+      dda->steps[i] = (config.steps[i] < 0)
+        ? (uint16_t)-config.steps[i]
+        : (uint16_t)config.steps[i];
+      if (dda->steps[i] > most) {
+        most = dda->steps[i];
+      }
+    }
+
+    dda->level = 0;
+    while (dda->level < config.max_level
+      && ((uint32_t)2 << dda->level) <= config.interval
+    ) {
+      dda->level++;
+    }
+
+    dda->events = (uint32_t)most << dda->level;
+    dda->events_left = dda->events;
+    dda->interval = config.interval;
+    // the first event falls on the first tick
+    dda->phase = config.interval - ((uint32_t)1 << dda->level);
+    // starting half way rounds each step to the nearest event
+    for (i=0;i<config.num_axes;i++) {
+      dda->error[i] = dda->events / 2;
+    }
+  }
+
+  return err;
+}
+
+// call from the step timer isr ahead of stepper_stepEngage(). events are
+// spread evenly over the ticks, and each event adds every motor's steps to
+// its error, stepping it when the error passes a whole step. a motor that
+// falls behind catches up since its target is moved on from the last one
+dda_err_t dda_tick(dda_t *dda, const stepper_descriptor_t *handles) {
+  dda_err_t err = DDA_ERR_NONE;
+  uint8_t i;
+
+  for (i=0;i<dda->num_axes;i++) {
+    if (stepper_getStatus(handles[i]) == STEPPER_STATUS_AVAILABLE) {
+      err = DDA_ERR_HANDLE_INVALID;
+    }
+  }
+
+  if (err == DDA_ERR_NONE && dda->events_left > 0) {
+    dda->phase += (uint32_t)1 << dda->level;
+    if (dda->phase >= dda->interval) {
+      dda->phase -= dda->interval;
+      dda->events_left--;
+      for (i=0;i<dda->num_axes;i++) {
+        dda->error[i] += dda->steps[i];
+        if (dda->error[i] >= dda->events) {
+          dda->error[i] -= dda->events;
+          stepper_move(handles[i], dda->dir[i]);
+        }
+      }
+    }
+  }
+
+  return err;
+}
+
+uint8_t dda_isDone(dda_t *dda) {
+  return dda->events_left == 0;
+}
+
+uint8_t dda_getLevel(dda_t *dda) {
+  return dda->level;
+}
@@ -0,0 +1,54 @@
+#ifndef _DDA_H
+#define _DDA_H
+
+#include <stdint.h>
+#include "stepper.h"
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+#define DDA_MAX_AXES 2
+// the furthest going motor's steps are split into at most 1 << DDA_MAX_LEVEL
+#define DDA_MAX_LEVEL 8
+
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum dda_err_t {
+  DDA_ERR_NONE,
+  DDA_ERR_OPTION_INVALID,
+  DDA_ERR_HANDLE_INVALID
+} dda_err_t;
+
+// steps is how far each motor goes and interval the ticks between steps of
+// the one going furthest. with max_level above 0 slow segments are
+// oversampled, so the other motors step on the nearest tick rather than
+// waiting for the furthest one to step
+typedef struct dda_attr_t {
+  int16_t steps[DDA_MAX_AXES];
+  uint8_t num_axes;
+  uint16_t interval;
+  uint8_t max_level;
+} dda_attr_t;
+
+typedef struct dda_t {
+  uint8_t num_axes;
+  uint16_t steps[DDA_MAX_AXES];
+  int8_t dir[DDA_MAX_AXES];
+  uint32_t error[DDA_MAX_AXES];
+  // one event per (1 << level) of the furthest motor's steps
+  uint32_t events;
+  uint32_t events_left;
+  uint16_t interval;
+  uint32_t phase;
+  uint8_t level;
+} dda_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+dda_err_t dda_plan(dda_t *dda, dda_attr_t config);
+dda_err_t dda_tick(dda_t *dda, const stepper_descriptor_t *handles);
+uint8_t dda_isDone(dda_t *dda);
+uint8_t dda_getLevel(dda_t *dda);
+
+#endif // _DDA_H
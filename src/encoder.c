@@ -0,0 +1,211 @@
+#include "encoder.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_ENCODERS 2
+#define MAX_STEPPERS 2
+#define MAX_STEPPER_POS 199
+#define NUM_STEPPER_POS (MAX_STEPPER_POS + 1)
+#define ENCODER_GLITCH 2
+
+/*******************************************************************************
+* Private Typedefs
+*******************************************************************************/
+typedef struct encoder_t {
+  uint8_t *pin_reg;
+  uint8_t a_pin;
+  uint8_t b_pin;
+
+  stepper_descriptor_t stepper;
+  uint8_t counts_per_step;
+  uint8_t max_error;
+  uint8_t correct;
+
+  encoder_status_t status;
+  uint8_t state;
+  uint16_t count;
+  uint8_t glitches;
+} encoder_t;
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static encoder_t encoders[MAX_ENCODERS];
+
+// indexed by (previous state << 2) | current state, where a state is
+// (a << 1) | b; both channels changing at once is a missed edge
+static const int8_t quadrature[16] = {
+  0, 1, -1, ENCODER_GLITCH,
+  -1, 0, ENCODER_GLITCH, 1,
+  1, ENCODER_GLITCH, 0, -1,
+  ENCODER_GLITCH, -1, 1, 0
+};
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static uint8_t _readState(encoder_descriptor_t handle);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+encoder_err_t encoder_construct(
+  encoder_attr_t config,
+  encoder_descriptor_t *handle
+) {
+  uint8_t i;
+  encoder_err_t err = ENCODER_ERR_NONE_AVAILABLE;
+
+  if (config.counts_per_step == 0) {
+    err = ENCODER_ERR_OPTION_INVALID;
+  } else if (config.stepper >= MAX_STEPPERS
+    || stepper_getStatus(config.stepper) == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = ENCODER_ERR_HANDLE_INVALID;
+  } else {
+    for (i=0;i<MAX_ENCODERS;i++) {
+      if (encoders[i].status == ENCODER_STATUS_AVAILABLE) {
+        encoders[i].pin_reg = config.pin_reg;
+        encoders[i].a_pin = config.a_pin;
+        encoders[i].b_pin = config.b_pin;
+
+        encoders[i].stepper = config.stepper;
+        encoders[i].counts_per_step = config.counts_per_step;
+        encoders[i].max_error = config.max_error;
+        encoders[i].correct = config.correct;
+
+        *config.pin_ddr &= ~(1 << config.a_pin);
+        *config.pin_ddr &= ~(1 << config.b_pin);
+
+        // start out agreeing with wherever the stepper thinks it is
+        encoders[i].status = ENCODER_STATUS_TRACKING;
+        encoders[i].state = _readState(i);
+        encoders[i].count = (uint16_t)stepper_getPos(config.stepper)
+          * config.counts_per_step;
+        encoders[i].glitches = 0;
+
+        *handle = i;
+
+        err = ENCODER_ERR_NONE;
+        break;
+      }
+    }
+  }
+
+  return err;
+}
+
+void encoder_destruct(encoder_descriptor_t handle) {
+  encoders[handle].status = ENCODER_STATUS_AVAILABLE;
+}
+
+// call from the pin change interrupt for the a and b lines
+void encoder_update(encoder_descriptor_t handle) {
+  uint8_t state = _readState(handle);
+  int8_t delta = quadrature[(encoders[handle].state << 2) | state];
+
+  encoders[handle].state = state;
+  if (delta == ENCODER_GLITCH) {
+    if (encoders[handle].glitches < UINT8_MAX) {
+      encoders[handle].glitches++;
+    }
+  } else if (delta > 0) {
+    encoders[handle].count++;
+    if (encoders[handle].count
+      == (uint16_t)NUM_STEPPER_POS * encoders[handle].counts_per_step
+    ) {
+      encoders[handle].count = 0;
+    }
+  } else if (delta < 0) {
+    if (encoders[handle].count == 0) {
+      encoders[handle].count = (uint16_t)NUM_STEPPER_POS
+        * encoders[handle].counts_per_step;
+    }
+    encoders[handle].count--;
+  }
+}
+
+// compares the measured position against the stepper, latching a fault when
+// they differ by more than max_error and, if enabled, queueing the lost steps
+// when they can be made up in the direction the axis is already moving
+encoder_err_t encoder_check(encoder_descriptor_t handle) {
+  encoder_err_t err = ENCODER_ERR_NONE;
+  int8_t error;
+  stepper_dir_t dir;
+
+  if (handle >= MAX_ENCODERS
+    || encoders[handle].status == ENCODER_STATUS_AVAILABLE
+  ) {
+    err = ENCODER_ERR_HANDLE_INVALID;
+  } else {
+    error = encoder_getFollowingError(handle);
+    if (error > encoders[handle].max_error
+      || error < -encoders[handle].max_error
+    ) {
+      encoders[handle].status = ENCODER_STATUS_FAULT;
+      if (encoders[handle].correct) {
+        dir = stepper_getDir(encoders[handle].stepper);
+        if (error > 0 && dir == STEPPER_DIR_FORWARD) {
+          stepper_setCorrection(encoders[handle].stepper, (uint8_t)error);
+        } else if (error < 0 && dir == STEPPER_DIR_REVERSE) {
+          stepper_setCorrection(encoders[handle].stepper, (uint8_t)-error);
+        }
+      }
+    }
+  }
+
+  return err;
+}
+
+encoder_err_t encoder_clearFault(encoder_descriptor_t handle) {
+  encoder_err_t err = ENCODER_ERR_NONE;
+
+  if (handle >= MAX_ENCODERS
+    || encoders[handle].status == ENCODER_STATUS_AVAILABLE
+  ) {
+    err = ENCODER_ERR_HANDLE_INVALID;
+  } else {
+    encoders[handle].status = ENCODER_STATUS_TRACKING;
+    encoders[handle].glitches = 0;
+  }
+
+  return err;
+}
+
+encoder_status_t encoder_getStatus(encoder_descriptor_t handle) {
+  return encoders[handle].status;
+}
+
+uint8_t encoder_getPos(encoder_descriptor_t handle) {
+  return (uint8_t)(encoders[handle].count / encoders[handle].counts_per_step);
+}
+
+// commanded minus measured position, positive when the axis is behind a
+// forward move, taken the short way round the revolution
+int8_t encoder_getFollowingError(encoder_descriptor_t handle) {
+  int16_t error = (int16_t)stepper_getPos(encoders[handle].stepper)
+    - encoder_getPos(handle);
+
+  if (error >= NUM_STEPPER_POS / 2) {
+    error -= NUM_STEPPER_POS;
+  } else if (error < -(NUM_STEPPER_POS / 2)) {
+    error += NUM_STEPPER_POS;
+  }
+
+  return (int8_t)error;
+}
+
+uint8_t encoder_getGlitches(encoder_descriptor_t handle) {
+  return encoders[handle].glitches;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static uint8_t _readState(encoder_descriptor_t handle) {
+  uint8_t pins = *encoders[handle].pin_reg;
+
+  return (uint8_t)((((pins >> encoders[handle].a_pin) & 1) << 1)
+    | ((pins >> encoders[handle].b_pin) & 1));
+}
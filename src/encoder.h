@@ -0,0 +1,54 @@
+#ifndef _ENCODER_H
+#define _ENCODER_H
+
+#include <stdint.h>
+#include "stepper.h"
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum encoder_err_t {
+  ENCODER_ERR_NONE,
+  ENCODER_ERR_NONE_AVAILABLE,
+  ENCODER_ERR_HANDLE_INVALID,
+  ENCODER_ERR_OPTION_INVALID
+} encoder_err_t;
+
+typedef enum encoder_status_t {
+  ENCODER_STATUS_AVAILABLE,
+  ENCODER_STATUS_TRACKING,
+  ENCODER_STATUS_FAULT
+} encoder_status_t;
+
+// the encoder reads the driven axis rather than the motor shaft, so backlash
+// and correction steps, which don't move pos, don't show up as error
+typedef struct encoder_attr_t {
+  uint8_t *pin_reg;
+  uint8_t *pin_ddr;
+  uint8_t a_pin;
+  uint8_t b_pin;
+
+  stepper_descriptor_t stepper;
+  uint8_t counts_per_step;
+  uint8_t max_error;
+  uint8_t correct;
+} encoder_attr_t;
+
+typedef uint8_t encoder_descriptor_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+encoder_err_t encoder_construct(
+  encoder_attr_t config,
+  encoder_descriptor_t *handle
+);
+void encoder_destruct(encoder_descriptor_t handle);
+void encoder_update(encoder_descriptor_t handle);
+encoder_err_t encoder_check(encoder_descriptor_t handle);
+encoder_err_t encoder_clearFault(encoder_descriptor_t handle);
+encoder_status_t encoder_getStatus(encoder_descriptor_t handle);
+uint8_t encoder_getPos(encoder_descriptor_t handle);
+int8_t encoder_getFollowingError(encoder_descriptor_t handle);
+uint8_t encoder_getGlitches(encoder_descriptor_t handle);
+
+#endif // _ENCODER_H
@@ -0,0 +1,460 @@
+#include "gcode.h"
+#include "motion.h"
+#include "arc.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPER_POS 199
+#define GCODE_UNIT 1000
+// keeps value * 10 + digit inside an int32 while still scaled by GCODE_UNIT
+#define GCODE_MAX_INT 2000000L
+#define GCODE_FRAC_DIGITS 3
+
+/*******************************************************************************
+* Private Typedefs
+*******************************************************************************/
+typedef enum gcode_comment_t {
+  GCODE_COMMENT_NONE,
+  GCODE_COMMENT_PAREN,
+  GCODE_COMMENT_LINE
+} gcode_comment_t;
+
+typedef enum gcode_action_t {
+  GCODE_ACTION_NONE,
+  GCODE_ACTION_MOVE,
+  GCODE_ACTION_ARC_CW,
+  GCODE_ACTION_ARC_CCW,
+  GCODE_ACTION_DWELL,
+  GCODE_ACTION_HOME,
+  GCODE_ACTION_ENABLE,
+  GCODE_ACTION_DISABLE
+} gcode_action_t;
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static ringbuf_t *rx_buf;
+
+// the line being parsed
+static gcode_word_t words[GCODE_MAX_WORDS];
+static uint8_t num_words;
+static gcode_err_t line_err;
+static gcode_comment_t comment;
+
+// the number being parsed into the last word
+static uint8_t in_word;
+static uint8_t num_digits;
+static uint8_t negative;
+static int8_t frac_digits;
+static int32_t int_part;
+static int32_t frac_part;
+
+// modal state, positions are where the queued moves will leave each axis
+static uint8_t absolute;
+static uint8_t feed;
+static uint8_t planned[MOTION_MAX_AXES];
+
+static uint16_t lines;
+static uint16_t errors;
+static gcode_err_t last_err;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _feed(uint8_t c);
+static void _startWord(uint8_t letter);
+static void _addToWord(uint8_t c);
+static void _endWord(void);
+static void _endLine(void);
+static gcode_err_t _execute(void);
+static gcode_err_t _arc(
+  motion_cmd_t *cmd,
+  const int32_t *values,
+  const int32_t *offsets
+);
+static int32_t _round(int32_t value);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// motion_init() must already have been called, the axes start out wherever
+// their steppers are
+void gcode_init(ringbuf_t *rx) {
+  uint8_t i;
+
+  rx_buf = rx;
+  num_words = 0;
+  line_err = GCODE_ERR_NONE;
+  comment = GCODE_COMMENT_NONE;
+  in_word = 0;
+  absolute = 1;
+  feed = 0;
+  lines = 0;
+  errors = 0;
+  last_err = GCODE_ERR_NONE;
+
+  for (i=0;i<motion_getNumAxes();i++) {
+    planned[i] = motion_getPos(i);
+  }
+}
+
+// parses whatever has arrived so far, stopping while the motion queue is full
+// so a finished line always has room for the command it makes
+void gcode_poll(void) {
+  uint8_t c;
+
+  while (motion_getFree() > 0 && ringbuf_get(rx_buf, &c)) {
+    _feed(c);
+  }
+}
+
+uint16_t gcode_getLines(void) {
+  return lines;
+}
+
+uint16_t gcode_getErrors(void) {
+  return errors;
+}
+
+gcode_err_t gcode_getLastError(void) {
+  return last_err;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static void _feed(uint8_t c) {
+  if (c == '\n' || c == '\r') {
+    _endLine();
+  } else if (comment == GCODE_COMMENT_LINE) {
+    // skip to the end of the line
+  } else if (comment == GCODE_COMMENT_PAREN) {
+    if (c == ')') {
+      comment = GCODE_COMMENT_NONE;
+    }
+  } else if (c == '(') {
+    _endWord();
+    comment = GCODE_COMMENT_PAREN;
+  } else if (c == ';' || c == '*') {
+    // a checksum is treated like a comment, the link is trusted
+    _endWord();
+    comment = GCODE_COMMENT_LINE;
+  } else if (c == ' ' || c == '\t') {
+    // whitespace is allowed anywhere, even inside a word
+  } else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+    _endWord();
+    _startWord(c & ~0x20);
+  } else if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.') {
+    _addToWord(c);
+  } else if (line_err == GCODE_ERR_NONE) {
+    line_err = GCODE_ERR_SYNTAX;
+  }
+}
+
+static void _startWord(uint8_t letter) {
+  if (num_words >= GCODE_MAX_WORDS) {
+    if (line_err == GCODE_ERR_NONE) {
+      line_err = GCODE_ERR_TOO_LONG;
+    }
+  } else {
+    words[num_words].letter = letter;
+    in_word = 1;
+    num_digits = 0;
+    negative = 0;
+    frac_digits = -1;
+    int_part = 0;
+    frac_part = 0;
+  }
+}
+
+static void _addToWord(uint8_t c) {
+  if (!in_word) {
+    // a number without a letter, or one belonging to a word already dropped
+    // for making the line too long
+    if (line_err == GCODE_ERR_NONE) {
+      line_err = GCODE_ERR_SYNTAX;
+    }
+  } else if (c == '-' || c == '+') {
+    if (num_digits > 0 || frac_digits >= 0 || negative) {
+      line_err = GCODE_ERR_SYNTAX;
+    } else {
+      negative = (c == '-');
+    }
+  } else if (c == '.') {
+    if (frac_digits >= 0) {
+      line_err = GCODE_ERR_SYNTAX;
+    } else {
+      frac_digits = 0;
+    }
+  } else if (frac_digits >= 0) {
+    // digits past the precision we keep are dropped
+    if (frac_digits < GCODE_FRAC_DIGITS) {
+      frac_part = frac_part * 10 + (c - '0');
+      frac_digits++;
+    }
+    num_digits++;
+  } else if (int_part >= GCODE_MAX_INT / 10) {
+    line_err = GCODE_ERR_RANGE;
+  } else {
+    int_part = int_part * 10 + (c - '0');
+    num_digits++;
+  }
+}
+
+static void _endWord(void) {
+  int32_t value;
+
+  if (in_word) {
+    in_word = 0;
+    if (num_digits == 0) {
+      line_err = GCODE_ERR_SYNTAX;
+    } else {
+      value = frac_part;
+      while (frac_digits < GCODE_FRAC_DIGITS) {
+        value *= 10;
+        frac_digits++;
+      }
+      value += int_part * GCODE_UNIT;
+      words[num_words].value = negative ? -value : value;
+      num_words++;
+    }
+  }
+}
+
+static void _endLine(void) {
+  gcode_err_t err;
+
+  _endWord();
+  err = line_err;
+  if (err == GCODE_ERR_NONE && num_words > 0) {
+    err = _execute();
+  }
+
+  if (err != GCODE_ERR_NONE) {
+    errors++;
+    last_err = err;
+  } else if (num_words > 0) {
+    lines++;
+  }
+
+  num_words = 0;
+  line_err = GCODE_ERR_NONE;
+  comment = GCODE_COMMENT_NONE;
+}
+
+static gcode_err_t _execute(void) {
+  gcode_err_t err = GCODE_ERR_NONE;
+  motion_cmd_t cmd;
+  uint8_t i;
+  uint8_t axis;
+  uint8_t num_axes = motion_getNumAxes();
+  uint8_t all_axes = (1 << num_axes) - 1;
+  uint8_t given = 0;
+  int32_t values[MOTION_MAX_AXES];
+  int32_t offsets[MOTION_MAX_AXES] = {0};
+  int32_t code;
+  int32_t dwell = -1;
+  int32_t target;
+  int32_t new_feed = -1;
+  gcode_action_t action = GCODE_ACTION_NONE;
+  uint8_t new_absolute = absolute;
+
+  for (i=0;i<num_words && err == GCODE_ERR_NONE;i++) {
+    code = words[i].value / GCODE_UNIT;
+    if (words[i].letter == 'G' || words[i].letter == 'M') {
+      if (words[i].value % GCODE_UNIT != 0 || words[i].value < 0) {
+        err = GCODE_ERR_UNSUPPORTED;
+      } else if (words[i].letter == 'G' && code == 90) {
+        new_absolute = 1;
+      } else if (words[i].letter == 'G' && code == 91) {
+        new_absolute = 0;
+      } else if (action != GCODE_ACTION_NONE) {
+        // one command per line besides the distance mode
+        err = GCODE_ERR_SYNTAX;
+      } else if (words[i].letter == 'G' && (code == 0 || code == 1)) {
+        action = GCODE_ACTION_MOVE;
+      } else if (words[i].letter == 'G' && (code == 2 || code == 3)) {
+        action = (code == 2) ? GCODE_ACTION_ARC_CW : GCODE_ACTION_ARC_CCW;
+      } else if (words[i].letter == 'G' && code == 4) {
+        action = GCODE_ACTION_DWELL;
+      } else if (words[i].letter == 'G' && code == 28) {
+        action = GCODE_ACTION_HOME;
+      } else if (words[i].letter == 'M' && code == 17) {
+        action = GCODE_ACTION_ENABLE;
+      } else if (words[i].letter == 'M' && code == 18) {
+        action = GCODE_ACTION_DISABLE;
+      } else {
+        err = GCODE_ERR_UNSUPPORTED;
+      }
+    } else if (words[i].letter == 'X' || words[i].letter == 'Y') {
+      axis = words[i].letter - 'X';
+      if (axis >= num_axes) {
+        err = GCODE_ERR_RANGE;
+      } else {
+        values[axis] = words[i].value;
+        given |= (1 << axis);
+      }
+    } else if (words[i].letter == 'I' || words[i].letter == 'J') {
+      // arc centre, always relative to the start
+      offsets[words[i].letter - 'I'] = words[i].value;
+    } else if (words[i].letter == 'F') {
+      new_feed = _round(words[i].value);
+      if (new_feed < 1 || new_feed > UINT8_MAX) {
+        err = GCODE_ERR_RANGE;
+      }
+    } else if (words[i].letter == 'P') {
+      // milliseconds
+      dwell = _round(words[i].value);
+    } else if (words[i].letter == 'S') {
+      // seconds, which the thousandths scaling already turns into ms
+      dwell = words[i].value;
+    } else if (words[i].letter != 'N') {
+      err = GCODE_ERR_UNSUPPORTED;
+    }
+  }
+
+  if (err == GCODE_ERR_NONE) {
+    cmd.op = MOTION_OP_MOVE;
+    cmd.axes = given;
+    cmd.speed = (new_feed > 0) ? (uint8_t)new_feed : feed;
+    cmd.dwell_ms = 0;
+    for (i=0;i<MOTION_MAX_AXES;i++) {
+      cmd.target[i] = 0;
+      cmd.center[i] = 0;
+    }
+
+    if (action == GCODE_ACTION_DWELL) {
+      cmd.op = MOTION_OP_DWELL;
+      if (dwell < 0 || dwell > UINT16_MAX) {
+        err = GCODE_ERR_RANGE;
+      } else {
+        cmd.dwell_ms = (uint16_t)dwell;
+      }
+    } else if (action == GCODE_ACTION_ENABLE
+      || action == GCODE_ACTION_DISABLE
+    ) {
+      cmd.op = (action == GCODE_ACTION_ENABLE)
+        ? MOTION_OP_ENABLE
+        : MOTION_OP_DISABLE;
+      if (given == 0) {
+        cmd.axes = all_axes;
+      }
+    } else if (action == GCODE_ACTION_ARC_CW
+      || action == GCODE_ACTION_ARC_CCW
+    ) {
+      cmd.op = (action == GCODE_ACTION_ARC_CW)
+        ? MOTION_OP_ARC_CW
+        : MOTION_OP_ARC_CCW;
+      for (i=0;i<num_axes;i++) {
+        if (!(given & (1 << i))) {
+          values[i] = new_absolute ? (int32_t)planned[i] * GCODE_UNIT : 0;
+        }
+        if (!new_absolute) {
+          values[i] += (int32_t)planned[i] * GCODE_UNIT;
+        }
+      }
+      err = _arc(&cmd, values, offsets);
+    } else if (action == GCODE_ACTION_HOME) {
+      // there are no endstops, home is position zero
+      if (given == 0) {
+        cmd.axes = all_axes;
+      }
+    } else if (given != 0) {
+      // G0 and G1 are the same move, an axis word on its own repeats it
+      for (i=0;i<num_axes && err == GCODE_ERR_NONE;i++) {
+        target = planned[i];
+        if (given & (1 << i)) {
+          target = _round(values[i]) + (new_absolute ? 0 : planned[i]);
+        }
+        if (target < 0 || target > MAX_STEPPER_POS) {
+          err = GCODE_ERR_RANGE;
+        } else {
+          cmd.target[i] = (uint8_t)target;
+        }
+      }
+    } else {
+      // only modal words on this line
+      cmd.axes = 0;
+    }
+  }
+
+  if (err == GCODE_ERR_NONE) {
+    if (cmd.axes != 0 || cmd.op == MOTION_OP_DWELL) {
+      motion_push(&cmd);
+      if (cmd.op == MOTION_OP_MOVE
+        || cmd.op == MOTION_OP_ARC_CW
+        || cmd.op == MOTION_OP_ARC_CCW
+      ) {
+        for (i=0;i<num_axes;i++) {
+          if (cmd.axes & (1 << i)) {
+            planned[i] = cmd.target[i];
+          }
+        }
+      }
+    }
+    absolute = new_absolute;
+    if (new_feed > 0) {
+      feed = (uint8_t)new_feed;
+    }
+  }
+
+  return err;
+}
+
+// fills in an arc from the planned position to values around the centre at
+// offsets from it, checking the end is on the circle
+static gcode_err_t _arc(
+  motion_cmd_t *cmd,
+  const int32_t *values,
+  const int32_t *offsets
+) {
+  gcode_err_t err = GCODE_ERR_NONE;
+  arc_t check;
+  arc_attr_t config;
+  int32_t target;
+  uint8_t i;
+
+  if (motion_getNumAxes() < 2) {
+    err = GCODE_ERR_RANGE;
+  }
+  for (i=0;i<2 && err == GCODE_ERR_NONE;i++) {
+    target = _round(values[i]);
+    cmd->center[i] = (int16_t)_round(offsets[i]);
+    if (target < 0 || target > MAX_STEPPER_POS
+      || cmd->center[i] > MAX_STEPPER_POS
+      || cmd->center[i] < -MAX_STEPPER_POS
+    ) {
+      err = GCODE_ERR_RANGE;
+    } else {
+      cmd->target[i] = (uint8_t)target;
+    }
+  }
+
+  if (err == GCODE_ERR_NONE) {
+    cmd->axes = 0x03;
+    config.start_x = -cmd->center[0];
+    config.start_y = -cmd->center[1];
+    config.end_x = cmd->target[0] - (planned[0] + cmd->center[0]);
+    config.end_y = cmd->target[1] - (planned[1] + cmd->center[1]);
+    config.dir = (cmd->op == MOTION_OP_ARC_CW) ? ARC_DIR_CW : ARC_DIR_CCW;
+    if (arc_plan(&check, config) != ARC_ERR_NONE) {
+      err = GCODE_ERR_RANGE;
+    }
+  }
+
+  return err;
+}
+
+// rounds a value in thousandths to the nearest whole number
+static int32_t _round(int32_t value) {
+  int32_t steps;
+
+  if (value < 0) {
+    steps = -((-value + GCODE_UNIT / 2) / GCODE_UNIT);
+  } else {
+    steps = (value + GCODE_UNIT / 2) / GCODE_UNIT;
+  }
+
+  return steps;
+}
@@ -0,0 +1,37 @@
+#ifndef _GCODE_H
+#define _GCODE_H
+
+#include <stdint.h>
+#include "ringbuf.h"
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+#define GCODE_MAX_WORDS 8
+
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum gcode_err_t {
+  GCODE_ERR_NONE,
+  GCODE_ERR_SYNTAX,
+  GCODE_ERR_UNSUPPORTED,
+  GCODE_ERR_RANGE,
+  GCODE_ERR_TOO_LONG
+} gcode_err_t;
+
+// values are kept in thousandths so X12.5 is stored as 12500
+typedef struct gcode_word_t {
+  uint8_t letter;
+  int32_t value;
+} gcode_word_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+void gcode_init(ringbuf_t *rx);
+void gcode_poll(void);
+uint16_t gcode_getLines(void);
+uint16_t gcode_getErrors(void);
+gcode_err_t gcode_getLastError(void);
+
+#endif // _GCODE_H
@@ -0,0 +1,219 @@
+#include "group.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPERS 2
+#define MAX_STEPPER_POS 199
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static group_err_t _checkStage(group_t *group, uint8_t axis);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// the steppers must already be constructed
+group_err_t group_init(
+  group_t *group,
+  const stepper_descriptor_t *handles,
+  uint8_t num_axes
+) {
+  group_err_t err = GROUP_ERR_NONE;
+  uint8_t i;
+  uint8_t j;
+
+  if (num_axes == 0 || num_axes > GROUP_MAX_AXES) {
+    err = GROUP_ERR_AXIS_INVALID;
+  } else {
+    for (i=0;i<num_axes;i++) {
+      if (handles[i] >= MAX_STEPPERS
+        || stepper_getStatus(handles[i]) == STEPPER_STATUS_AVAILABLE
+      ) {
+        err = GROUP_ERR_HANDLE_INVALID;
+      }
+      // the batched stepper calls refuse a stepper listed twice
+      for (j=0;j<i;j++) {
+        if (handles[j] == handles[i]) {
+          err = GROUP_ERR_HANDLE_INVALID;
+        }
+      }
+    }
+  }
+
+  if (err == GROUP_ERR_NONE) {
+    for (i=0;i<num_axes;i++) {
+      group->handles[i] = handles[i];
+      group->stage[i].staged = 0;
+    }
+    group->num_axes = num_axes;
+    group->commit = 0;
+  }
+
+  return err;
+}
+
+group_err_t group_stageTarget(
+  group_t *group,
+  uint8_t axis,
+  uint8_t pos_1,
+  uint8_t pos_2,
+  stepper_dir_t dir
+) {
+  group_err_t err = _checkStage(group, axis);
+
+  if (err != GROUP_ERR_NONE) {
+    // nothing to stage
+  } else if (pos_1 > MAX_STEPPER_POS
+    || pos_2 > MAX_STEPPER_POS
+    || (dir != STEPPER_DIR_FORWARD && dir != STEPPER_DIR_REVERSE)
+  ) {
+    err = GROUP_ERR_OPTION_INVALID;
+  } else {
+    group->stage[axis].pos_1 = pos_1;
+    group->stage[axis].pos_2 = pos_2;
+    group->stage[axis].dir = dir;
+    group->stage[axis].staged |= GROUP_STAGED_TARGET;
+  }
+
+  return err;
+}
+
+group_err_t group_stageMode(group_t *group, uint8_t axis, stepper_mode_t mode) {
+  group_err_t err = _checkStage(group, axis);
+
+  if (err != GROUP_ERR_NONE) {
+    // nothing to stage
+  } else if (mode != STEPPER_MODE_NORMAL
+    && mode != STEPPER_MODE_OSCILLATE
+    && mode != STEPPER_MODE_CONTINUOUS
+  ) {
+    err = GROUP_ERR_OPTION_INVALID;
+  } else {
+    group->stage[axis].mode = mode;
+    group->stage[axis].staged |= GROUP_STAGED_MODE;
+  }
+
+  return err;
+}
+
+group_err_t group_stageSpeed(group_t *group, uint8_t axis, uint8_t speed) {
+  group_err_t err = _checkStage(group, axis);
+
+  if (err == GROUP_ERR_NONE) {
+    group->stage[axis].speed = speed;
+    group->stage[axis].staged |= GROUP_STAGED_SPEED;
+  }
+
+  return err;
+}
+
+group_err_t group_stageEnable(group_t *group, uint8_t axis, uint8_t enable) {
+  group_err_t err = _checkStage(group, axis);
+
+  if (err == GROUP_ERR_NONE) {
+    group->stage[axis].enable = enable;
+    group->stage[axis].staged |= GROUP_STAGED_ENABLE;
+  }
+
+  return err;
+}
+
+// everything staged takes effect together on the next group_tick(), nothing
+// more can be staged until then
+void group_commit(group_t *group) {
+  group->commit = 1;
+}
+
+uint8_t group_isCommitPending(group_t *group) {
+  return group->commit;
+}
+
+// call from the step timer isr before stepper_stepEngage() on any axis of the
+// group, so a commit lands between two steps and every axis sees it at once
+void group_tick(group_t *group) {
+  group_stage_t *stage;
+  stepper_descriptor_t handle;
+  uint8_t staged = 0;
+  uint8_t enable_mask = 0;
+  uint8_t reverse_mask = 0;
+  uint8_t i;
+
+  if (group->commit) {
+    for (i=0;i<group->num_axes;i++) {
+      stage = &group->stage[i];
+      handle = group->handles[i];
+      staged |= stage->staged;
+
+      // axes with nothing staged keep what they had
+      if (stage->staged & GROUP_STAGED_ENABLE) {
+        enable_mask |= (stage->enable ? 1 : 0) << i;
+      } else if (stepper_getStatus(handle) == STEPPER_STATUS_ENABLED) {
+        enable_mask |= (1 << i);
+      }
+      if (stage->staged & GROUP_STAGED_TARGET) {
+        reverse_mask |= (stage->dir == STEPPER_DIR_REVERSE) << i;
+      } else if (stepper_getDir(handle) == STEPPER_DIR_REVERSE) {
+        reverse_mask |= (1 << i);
+      }
+    }
+
+    if (staged & GROUP_STAGED_ENABLE) {
+      stepper_setEnables(group->handles, group->num_axes, enable_mask);
+    }
+    if (staged & GROUP_STAGED_TARGET) {
+      stepper_setDirs(group->handles, group->num_axes, reverse_mask);
+    }
+
+    for (i=0;i<group->num_axes;i++) {
+      stage = &group->stage[i];
+      handle = group->handles[i];
+      if (stage->staged & GROUP_STAGED_MODE) {
+        stepper_setMode(handle, stage->mode);
+      }
+      if (stage->staged & GROUP_STAGED_SPEED) {
+        stepper_setSpeed(handle, stage->speed);
+      }
+      if (stage->staged & GROUP_STAGED_TARGET) {
+        stepper_setPos(handle, stage->pos_1, stage->pos_2);
+      }
+      stage->staged = 0;
+    }
+
+    group->commit = 0;
+  }
+}
+
+// halts every axis where it stands and switches the drivers off in a single
+// pass, safe to call from an isr. anything staged is thrown away
+void group_stop(group_t *group) {
+  stepper_descriptor_t handle;
+  uint8_t i;
+
+  for (i=0;i<group->num_axes;i++) {
+    handle = group->handles[i];
+    stepper_setMode(handle, STEPPER_MODE_NORMAL);
+    stepper_setCorrection(handle, 0);
+    stepper_setPos(handle, stepper_getPos(handle), stepper_getPos(handle));
+    group->stage[i].staged = 0;
+  }
+  stepper_setEnables(group->handles, group->num_axes, 0);
+
+  group->commit = 0;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static group_err_t _checkStage(group_t *group, uint8_t axis) {
+  group_err_t err = GROUP_ERR_NONE;
+
+  if (group->commit) {
+    err = GROUP_ERR_BUSY;
+  } else if (axis >= group->num_axes) {
+    err = GROUP_ERR_AXIS_INVALID;
+  }
+
+  return err;
+}
@@ -0,0 +1,69 @@
+#ifndef _GROUP_H
+#define _GROUP_H
+
+#include <stdint.h>
+#include "stepper.h"
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+#define GROUP_MAX_AXES 2
+
+// which settings an axis has staged for the next commit
+#define GROUP_STAGED_TARGET (1 << 0)
+#define GROUP_STAGED_MODE (1 << 1)
+#define GROUP_STAGED_SPEED (1 << 2)
+#define GROUP_STAGED_ENABLE (1 << 3)
+
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum group_err_t {
+  GROUP_ERR_NONE,
+  GROUP_ERR_HANDLE_INVALID,
+  GROUP_ERR_AXIS_INVALID,
+  GROUP_ERR_OPTION_INVALID,
+  GROUP_ERR_BUSY
+} group_err_t;
+
+typedef struct group_stage_t {
+  uint8_t staged;
+  uint8_t pos_1;
+  uint8_t pos_2;
+  stepper_dir_t dir;
+  stepper_mode_t mode;
+  uint8_t speed;
+  uint8_t enable;
+} group_stage_t;
+
+typedef struct group_t {
+  stepper_descriptor_t handles[GROUP_MAX_AXES];
+  uint8_t num_axes;
+  group_stage_t stage[GROUP_MAX_AXES];
+  // set by group_commit(), cleared by the tick that applies the stage
+  volatile uint8_t commit;
+} group_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+group_err_t group_init(
+  group_t *group,
+  const stepper_descriptor_t *handles,
+  uint8_t num_axes
+);
+group_err_t group_stageTarget(
+  group_t *group,
+  uint8_t axis,
+  uint8_t pos_1,
+  uint8_t pos_2,
+  stepper_dir_t dir
+);
+group_err_t group_stageMode(group_t *group, uint8_t axis, stepper_mode_t mode);
+group_err_t group_stageSpeed(group_t *group, uint8_t axis, uint8_t speed);
+group_err_t group_stageEnable(group_t *group, uint8_t axis, uint8_t enable);
+void group_commit(group_t *group);
+uint8_t group_isCommitPending(group_t *group);
+void group_tick(group_t *group);
+void group_stop(group_t *group);
+
+#endif // _GROUP_H
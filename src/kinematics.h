@@ -0,0 +1,52 @@
+#ifndef _KINEMATICS_H
+#define _KINEMATICS_H
+
+#include <stdint.h>
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+// the machine is picked at build time with -DKINEMATICS_COREXY or
+// -DKINEMATICS_HBOT, which differ only in the sign of motor b. without either
+// each logical axis drives the motor with the same index. the transform is
+// inlined so it costs no more than the sums
+#if defined(KINEMATICS_COREXY) && defined(KINEMATICS_HBOT)
+#error "define only one of KINEMATICS_COREXY and KINEMATICS_HBOT"
+#endif
+
+#if defined(KINEMATICS_COREXY) || defined(KINEMATICS_HBOT)
+#define KINEMATICS_COUPLED 1
+#else
+#define KINEMATICS_COUPLED 0
+#endif
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// turns a move of the logical x and y axes into the moves of motors a and b.
+// any further axes map straight through. a coupled build needs num_axes of at
+// least 2
+static inline void kinematics_toMotors(
+  const int16_t *axes,
+  int16_t *motors,
+  uint8_t num_axes
+) {
+  uint8_t i;
+
+  for (i=0;i<num_axes;i++) {
+    motors[i] = axes[i];
+  }
+
+#if defined(KINEMATICS_COREXY)
+  // both belts run the whole loop, a = x + y and b = x - y
+  motors[0] = axes[0] + axes[1];
+  motors[1] = axes[0] - axes[1];
+#elif defined(KINEMATICS_HBOT)
+  // an h-bot's belt sums are the same as corexy's. this only flips the sign
+  // of b, for frames where the b motor is mounted facing the other way, and
+  // is corexy with b's direction reversed
+  motors[0] = axes[0] + axes[1];
+  motors[1] = axes[1] - axes[0];
+#endif
+}
+
+#endif // _KINEMATICS_H
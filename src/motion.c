@@ -0,0 +1,290 @@
+#include "motion.h"
+#include "arc.h"
+#include "kinematics.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MOTION_QUEUE_MASK (MOTION_QUEUE_SIZE - 1)
+#define MAX_STEPPER_POS 199
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static stepper_descriptor_t axis_handles[MOTION_MAX_AXES];
+static uint8_t axis_count;
+
+static motion_cmd_t queue[MOTION_QUEUE_SIZE];
+static uint8_t head;
+static uint8_t tail;
+
+// the command being carried out, if any
+static volatile uint8_t active;
+static motion_cmd_t current;
+static uint16_t dwell_start;
+static arc_t arc;
+
+// where the logical axes will be once the command or segment running now is
+// done, and the motors it has set going
+static int16_t logical[MOTION_MAX_AXES];
+static uint8_t moving;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _start(uint16_t now_ms);
+static uint8_t _isDone(uint16_t now_ms);
+static void _startSegment(void);
+static uint8_t _isSegmentLeft(void);
+static uint8_t _isArc(motion_op_t op);
+static arc_attr_t _arcConfig(const motion_cmd_t *cmd);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+motion_err_t motion_init(
+  const stepper_descriptor_t *handles,
+  uint8_t num_axes
+) {
+  motion_err_t err = MOTION_ERR_NONE;
+  uint8_t i;
+
+  // a coupled machine's motors each drive both x and y, so it has exactly
+  // those two axes
+  if (num_axes > MOTION_MAX_AXES
+    || (KINEMATICS_COUPLED && num_axes != 2)
+  ) {
+    err = MOTION_ERR_AXIS_INVALID;
+  } else {
+    for (i=0;i<num_axes;i++) {
+      axis_handles[i] = handles[i];
+    }
+    axis_count = num_axes;
+    // coupled machines count from wherever they were switched on
+    for (i=0;i<num_axes;i++) {
+      logical[i] = KINEMATICS_COUPLED ? 0 : stepper_getPos(handles[i]);
+    }
+    moving = 0;
+    head = 0;
+    tail = 0;
+    active = 0;
+  }
+
+  return err;
+}
+
+motion_err_t motion_push(const motion_cmd_t *cmd) {
+  motion_err_t err = MOTION_ERR_NONE;
+
+  if (cmd->axes >= (1 << axis_count)
+    || (_isArc(cmd->op) && cmd->axes != 0x03)
+  ) {
+    err = MOTION_ERR_AXIS_INVALID;
+  } else if (cmd->op != MOTION_OP_MOVE
+    && cmd->op != MOTION_OP_DWELL
+    && cmd->op != MOTION_OP_ENABLE
+    && cmd->op != MOTION_OP_DISABLE
+    && !_isArc(cmd->op)
+  ) {
+    err = MOTION_ERR_OPTION_INVALID;
+  } else if (motion_getFree() == 0) {
+    err = MOTION_ERR_QUEUE_FULL;
+  } else {
+    queue[head & MOTION_QUEUE_MASK] = *cmd;
+    head++;
+  }
+
+  return err;
+}
+
+// call from the main loop, starts the next queued command as soon as the
+// current one has finished
+void motion_poll(uint16_t now_ms) {
+  if (active && _isDone(now_ms)) {
+    // a long move on a coupled machine goes in more than one segment
+    if (current.op == MOTION_OP_MOVE && _isSegmentLeft()) {
+      _startSegment();
+    } else {
+      active = 0;
+    }
+  }
+
+  while (!active && head != tail) {
+    current = queue[tail & MOTION_QUEUE_MASK];
+    tail++;
+    _start(now_ms);
+    active = !_isDone(now_ms);
+  }
+}
+
+// call from the step timer isr before stepping, arcs are fed to the steppers
+// one step at a time from here
+void motion_tick(void) {
+  if (active && _isArc(current.op)) {
+    arc_tick(&arc, axis_handles[0], axis_handles[1]);
+  }
+}
+
+uint8_t motion_getFree(void) {
+  return MOTION_QUEUE_SIZE - (uint8_t)(head - tail);
+}
+
+uint8_t motion_isIdle(void) {
+  return !active && head == tail;
+}
+
+stepper_descriptor_t motion_getHandle(uint8_t axis) {
+  return axis_handles[axis];
+}
+
+uint8_t motion_getNumAxes(void) {
+  return axis_count;
+}
+
+// position of a logical axis once the running command is done
+uint8_t motion_getPos(uint8_t axis) {
+  return (uint8_t)logical[axis];
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static void _start(uint16_t now_ms) {
+  uint8_t i;
+  stepper_descriptor_t handle;
+
+  dwell_start = now_ms;
+  moving = 0;
+  // without coupling the motors are the axes, so pick up any change made
+  // to them directly
+  for (i=0;i<axis_count && !KINEMATICS_COUPLED;i++) {
+    logical[i] = stepper_getPos(axis_handles[i]);
+  }
+
+  if (current.op == MOTION_OP_MOVE) {
+    _startSegment();
+  } else if (_isArc(current.op)) {
+    // an arc that doesn't fit is dropped rather than left to wander
+    if (arc_plan(&arc, _arcConfig(&current)) == ARC_ERR_NONE) {
+      for (i=0;i<2;i++) {
+        logical[i] = current.target[i];
+        if (current.speed != 0) {
+          stepper_setSpeed(axis_handles[i], current.speed);
+        }
+      }
+      moving = 0x03;
+    } else {
+      arc.done = 1;
+    }
+  }
+
+  for (i=0;i<axis_count;i++) {
+    handle = axis_handles[i];
+    if (current.axes & (1 << i)) {
+      if (current.op == MOTION_OP_ENABLE) {
+        stepper_enable(handle);
+      } else if (current.op == MOTION_OP_DISABLE) {
+        stepper_disable(handle);
+      }
+    }
+  }
+}
+
+static uint8_t _isDone(uint16_t now_ms) {
+  uint8_t done = 1;
+  uint8_t i;
+  stepper_descriptor_t handle;
+
+  if (current.op == MOTION_OP_DWELL) {
+    done = (uint16_t)(now_ms - dwell_start) >= current.dwell_ms;
+  } else {
+    done = !_isArc(current.op) || arc_isDone(&arc);
+    for (i=0;i<axis_count;i++) {
+      handle = axis_handles[i];
+      if ((moving & (1 << i))
+        && (stepper_getPos(handle) != stepper_getDesiredPos1(handle)
+        || stepper_getBacklashPending(handle) != 0)
+      ) {
+        done = 0;
+      }
+    }
+  }
+
+  return done;
+}
+
+// sets the motors going towards the current move's target. positions are
+// treated as linear axes, so each motor heads the short way without wrapping
+// through zero, and a motor can't be sent further than once round
+static void _startSegment(void) {
+  int16_t delta[MOTION_MAX_AXES];
+  int16_t motors[MOTION_MAX_AXES];
+  uint8_t too_far;
+  uint8_t i;
+
+  for (i=0;i<axis_count;i++) {
+    delta[i] = 0;
+    if (current.axes & (1 << i)) {
+      delta[i] = current.target[i] - logical[i];
+    }
+  }
+
+  do {
+    kinematics_toMotors(delta, motors, axis_count);
+    too_far = 0;
+    for (i=0;i<axis_count;i++) {
+      if (motors[i] > MAX_STEPPER_POS || motors[i] < -MAX_STEPPER_POS) {
+        too_far = 1;
+      }
+    }
+    if (too_far) {
+      for (i=0;i<axis_count;i++) {
+        delta[i] /= 2;
+      }
+    }
+  } while (too_far);
+
+  for (i=0;i<axis_count;i++) {
+    logical[i] += delta[i];
+    if (motors[i] != 0) {
+      moving |= (1 << i);
+      if (current.speed != 0) {
+        stepper_setSpeed(axis_handles[i], current.speed);
+      }
+      stepper_move(axis_handles[i], motors[i]);
+    }
+  }
+}
+
+static uint8_t _isSegmentLeft(void) {
+  uint8_t left = 0;
+  uint8_t i;
+
+  for (i=0;i<axis_count;i++) {
+    if ((current.axes & (1 << i)) && logical[i] != current.target[i]) {
+      left = 1;
+    }
+  }
+
+  return left;
+}
+
+static uint8_t _isArc(motion_op_t op) {
+  return op == MOTION_OP_ARC_CW || op == MOTION_OP_ARC_CCW;
+}
+
+// where the arc starts and ends relative to its centre, the axes have to be
+// at the start already
+static arc_attr_t _arcConfig(const motion_cmd_t *cmd) {
+  arc_attr_t config;
+  int16_t center_x = logical[0] + cmd->center[0];
+  int16_t center_y = logical[1] + cmd->center[1];
+
+  config.start_x = -cmd->center[0];
+  config.start_y = -cmd->center[1];
+  config.end_x = cmd->target[0] - center_x;
+  config.end_y = cmd->target[1] - center_y;
+  config.dir = (cmd->op == MOTION_OP_ARC_CW) ? ARC_DIR_CW : ARC_DIR_CCW;
+
+  return config;
+}
@@ -0,0 +1,59 @@
+#ifndef _MOTION_H
+#define _MOTION_H
+
+#include <stdint.h>
+#include "stepper.h"
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+#define MOTION_MAX_AXES 2
+#define MOTION_QUEUE_SIZE 8
+
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum motion_err_t {
+  MOTION_ERR_NONE,
+  MOTION_ERR_QUEUE_FULL,
+  MOTION_ERR_AXIS_INVALID,
+  MOTION_ERR_OPTION_INVALID
+} motion_err_t;
+
+typedef enum motion_op_t {
+  MOTION_OP_MOVE,
+  MOTION_OP_DWELL,
+  MOTION_OP_ENABLE,
+  MOTION_OP_DISABLE,
+  MOTION_OP_ARC_CW,
+  MOTION_OP_ARC_CCW
+} motion_op_t;
+
+// axes is a bit mask of the axes a command applies to. a move sends each of
+// them to its target, with speed applied first unless it is 0. an arc runs
+// the first two axes to target around a centre offset from where they start
+typedef struct motion_cmd_t {
+  motion_op_t op;
+  uint8_t axes;
+  uint8_t target[MOTION_MAX_AXES];
+  int16_t center[MOTION_MAX_AXES];
+  uint8_t speed;
+  uint16_t dwell_ms;
+} motion_cmd_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+motion_err_t motion_init(
+  const stepper_descriptor_t *handles,
+  uint8_t num_axes
+);
+motion_err_t motion_push(const motion_cmd_t *cmd);
+void motion_poll(uint16_t now_ms);
+void motion_tick(void);
+uint8_t motion_getFree(void);
+uint8_t motion_isIdle(void);
+stepper_descriptor_t motion_getHandle(uint8_t axis);
+uint8_t motion_getNumAxes(void);
+uint8_t motion_getPos(uint8_t axis);
+
+#endif // _MOTION_H
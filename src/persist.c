@@ -0,0 +1,225 @@
+#include "persist.h"
+#include "crc8.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define PERSIST_SEQ 0
+#define PERSIST_POS 1
+#define PERSIST_STEP_SIZE 2
+#define PERSIST_CHECKSUM 3
+
+/*******************************************************************************
+* Private Typedefs
+*******************************************************************************/
+typedef struct persist_axis_t {
+  uint8_t next_slot;
+  uint8_t seq;
+  uint8_t saved;
+  uint8_t saved_pos;
+  stepper_step_size_t saved_step_size;
+} persist_axis_t;
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static const persist_backend_t *storage;
+static persist_axis_t axes[PERSIST_MAX_AXES];
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static uint16_t _slotAddr(stepper_descriptor_t handle, uint8_t slot);
+static uint8_t _checksum(const uint8_t *record);
+static uint8_t _readSlot(
+  stepper_descriptor_t handle,
+  uint8_t slot,
+  uint8_t *record
+);
+static int8_t _newestSlot(stepper_descriptor_t handle, uint8_t *record);
+static uint8_t _isIdle(stepper_descriptor_t handle);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// finds the newest record of every axis so saves carry on around the ring
+// from where the last power cycle left off
+void persist_init(const persist_backend_t *backend) {
+  uint8_t i;
+  int8_t slot;
+  uint8_t record[PERSIST_SLOT_SIZE];
+
+  storage = backend;
+  for (i=0;i<PERSIST_MAX_AXES;i++) {
+    axes[i].saved = 0;
+    slot = _newestSlot(i, record);
+    if (slot < 0) {
+      axes[i].next_slot = 0;
+      axes[i].seq = 0;
+    } else {
+      axes[i].next_slot = (uint8_t)(slot + 1) % PERSIST_SLOTS;
+      axes[i].seq = record[PERSIST_SEQ] + 1;
+    }
+  }
+}
+
+// writes the position and step size to the next slot in the axis' ring, the
+// checksum goes last so a write cut short by power loss never validates
+persist_err_t persist_save(stepper_descriptor_t handle) {
+  persist_err_t err = PERSIST_ERR_NONE;
+  uint8_t record[PERSIST_SLOT_SIZE];
+  uint8_t readback[PERSIST_SLOT_SIZE];
+  uint16_t addr;
+  uint8_t slot;
+  uint8_t i;
+
+  if (handle >= PERSIST_MAX_AXES
+    || stepper_getStatus(handle) == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = PERSIST_ERR_HANDLE_INVALID;
+  } else {
+    record[PERSIST_SEQ] = axes[handle].seq;
+    record[PERSIST_POS] = stepper_getPos(handle);
+    record[PERSIST_STEP_SIZE] = (uint8_t)stepper_getStepSize(handle);
+    record[PERSIST_CHECKSUM] = _checksum(record);
+
+    slot = axes[handle].next_slot;
+    addr = _slotAddr(handle, slot);
+    for (i=0;i<PERSIST_SLOT_SIZE;i++) {
+      storage->write(addr + i, record[i]);
+    }
+
+    // a worn slot is skipped rather than retried so the next save still
+    // moves on around the ring
+    axes[handle].next_slot = (slot + 1) % PERSIST_SLOTS;
+    _readSlot(handle, slot, readback);
+    for (i=0;i<PERSIST_SLOT_SIZE;i++) {
+      if (readback[i] != record[i]) {
+        err = PERSIST_ERR_WRITE_FAILED;
+      }
+    }
+
+    if (err == PERSIST_ERR_NONE) {
+      axes[handle].seq++;
+      axes[handle].saved = 1;
+      axes[handle].saved_pos = record[PERSIST_POS];
+      axes[handle].saved_step_size = (stepper_step_size_t)
+        record[PERSIST_STEP_SIZE];
+    }
+  }
+
+  return err;
+}
+
+// re-seeds pos and the step size from the newest valid record
+persist_err_t persist_restore(stepper_descriptor_t handle) {
+  persist_err_t err = PERSIST_ERR_NONE;
+  uint8_t record[PERSIST_SLOT_SIZE];
+
+  if (handle >= PERSIST_MAX_AXES
+    || stepper_getStatus(handle) == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = PERSIST_ERR_HANDLE_INVALID;
+  } else if (_newestSlot(handle, record) < 0
+    || stepper_seedPos(handle, record[PERSIST_POS]) != STEPPER_ERR_NONE
+  ) {
+    err = PERSIST_ERR_NOT_FOUND;
+  } else {
+    stepper_setStepSize(
+      handle,
+      (stepper_step_size_t)record[PERSIST_STEP_SIZE]
+    );
+    axes[handle].saved = 1;
+    axes[handle].saved_pos = record[PERSIST_POS];
+    axes[handle].saved_step_size = (stepper_step_size_t)
+      record[PERSIST_STEP_SIZE];
+  }
+
+  return err;
+}
+
+// call from the main loop, never the step isr, an eeprom byte takes a few
+// milliseconds to write. saves each axis once it's idle or disabled and its
+// position has changed since the last save
+void persist_poll(void) {
+  stepper_descriptor_t i;
+
+  for (i=0;i<PERSIST_MAX_AXES;i++) {
+    if (stepper_getStatus(i) != STEPPER_STATUS_AVAILABLE
+      && _isIdle(i)
+      && (axes[i].saved == 0
+      || axes[i].saved_pos != stepper_getPos(i)
+      || axes[i].saved_step_size != stepper_getStepSize(i))
+    ) {
+      persist_save(i);
+    }
+  }
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static uint16_t _slotAddr(stepper_descriptor_t handle, uint8_t slot) {
+  return storage->base
+    + ((uint16_t)handle * PERSIST_SLOTS + slot) * PERSIST_SLOT_SIZE;
+}
+
+// crc-8 over everything but the checksum byte itself
+static uint8_t _checksum(const uint8_t *record) {
+  uint8_t crc = 0;
+  uint8_t i;
+
+  for (i=0;i<PERSIST_CHECKSUM;i++) {
+    crc = crc8_update(crc, record[i]);
+  }
+
+  return crc;
+}
+
+// reads a slot and returns non-zero if its checksum holds
+static uint8_t _readSlot(
+  stepper_descriptor_t handle,
+  uint8_t slot,
+  uint8_t *record
+) {
+  uint16_t addr = _slotAddr(handle, slot);
+  uint8_t i;
+
+  for (i=0;i<PERSIST_SLOT_SIZE;i++) {
+    record[i] = storage->read(addr + i);
+  }
+
+  return record[PERSIST_CHECKSUM] == _checksum(record)
+    && record[PERSIST_STEP_SIZE] <= STEPPER_STEP_SIZE_SIXTEENTH;
+}
+
+// sequence numbers wrap, so a record is newer if it's less than half the
+// sequence space ahead
+static int8_t _newestSlot(stepper_descriptor_t handle, uint8_t *record) {
+  uint8_t candidate[PERSIST_SLOT_SIZE];
+  int8_t newest = -1;
+  uint8_t slot;
+  uint8_t i;
+
+  for (slot=0;slot<PERSIST_SLOTS;slot++) {
+    if (_readSlot(handle, slot, candidate)
+      && (newest < 0
+      || (int8_t)(candidate[PERSIST_SEQ] - record[PERSIST_SEQ]) > 0)
+    ) {
+      newest = (int8_t)slot;
+      for (i=0;i<PERSIST_SLOT_SIZE;i++) {
+        record[i] = candidate[i];
+      }
+    }
+  }
+
+  return newest;
+}
+
+static uint8_t _isIdle(stepper_descriptor_t handle) {
+  return stepper_getStatus(handle) == STEPPER_STATUS_DISABLED
+    || (stepper_getMode(handle) == STEPPER_MODE_NORMAL
+    && stepper_getPos(handle) == stepper_getDesiredPos1(handle)
+    && stepper_getBacklashPending(handle) == 0
+    && stepper_getCorrectionPending(handle) == 0);
+}
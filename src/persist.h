@@ -0,0 +1,40 @@
+#ifndef _PERSIST_H
+#define _PERSIST_H
+
+#include <stdint.h>
+#include "stepper.h"
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+#define PERSIST_SLOTS 16
+#define PERSIST_SLOT_SIZE 4
+#define PERSIST_MAX_AXES 2
+#define PERSIST_SIZE (PERSIST_MAX_AXES * PERSIST_SLOTS * PERSIST_SLOT_SIZE)
+
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum persist_err_t {
+  PERSIST_ERR_NONE,
+  PERSIST_ERR_HANDLE_INVALID,
+  PERSIST_ERR_NOT_FOUND,
+  PERSIST_ERR_WRITE_FAILED
+} persist_err_t;
+
+// byte access to the storage, on target these wrap eeprom_read_byte() and
+// eeprom_update_byte()
+typedef struct persist_backend_t {
+  uint8_t (*read)(uint16_t addr);
+  void (*write)(uint16_t addr, uint8_t value);
+  uint16_t base;
+} persist_backend_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+void persist_init(const persist_backend_t *backend);
+persist_err_t persist_save(stepper_descriptor_t handle);
+persist_err_t persist_restore(stepper_descriptor_t handle);
+void persist_poll(void);
+
+#endif // _PERSIST_H
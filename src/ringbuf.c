@@ -0,0 +1,58 @@
+#include "ringbuf.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define RINGBUF_MASK (RINGBUF_SIZE - 1)
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+void ringbuf_init(ringbuf_t *buf) {
+  buf->head = 0;
+  buf->tail = 0;
+}
+
+// returns 0 and drops the byte if the buffer is full
+uint8_t ringbuf_put(ringbuf_t *buf, uint8_t byte) {
+  uint8_t stored = 0;
+
+  if (ringbuf_getFree(buf) > 0) {
+    buf->data[buf->head & RINGBUF_MASK] = byte;
+    buf->head++;
+    stored = 1;
+  }
+
+  return stored;
+}
+
+// returns 0 if there was nothing to read
+uint8_t ringbuf_get(ringbuf_t *buf, uint8_t *byte) {
+  uint8_t read = ringbuf_peek(buf, byte);
+
+  if (read) {
+    buf->tail++;
+  }
+
+  return read;
+}
+
+uint8_t ringbuf_peek(ringbuf_t *buf, uint8_t *byte) {
+  uint8_t read = 0;
+
+  if (ringbuf_getCount(buf) > 0) {
+    *byte = buf->data[buf->tail & RINGBUF_MASK];
+    read = 1;
+  }
+
+  return read;
+}
+
+// the indices run freely and wrap at 256, so their difference is the count
+uint8_t ringbuf_getCount(ringbuf_t *buf) {
+  return (uint8_t)(buf->head - buf->tail);
+}
+
+uint8_t ringbuf_getFree(ringbuf_t *buf) {
+  return RINGBUF_SIZE - ringbuf_getCount(buf);
+}
@@ -0,0 +1,32 @@
+#ifndef _RINGBUF_H
+#define _RINGBUF_H
+
+#include <stdint.h>
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+// a power of two no larger than 128 so the free running indices still work
+#define RINGBUF_SIZE 64
+
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+// single producer (the uart rx isr) and single consumer (the main loop), each
+// side only ever writes its own index
+typedef struct ringbuf_t {
+  uint8_t data[RINGBUF_SIZE];
+  volatile uint8_t head;
+  volatile uint8_t tail;
+} ringbuf_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+void ringbuf_init(ringbuf_t *buf);
+uint8_t ringbuf_put(ringbuf_t *buf, uint8_t byte);
+uint8_t ringbuf_get(ringbuf_t *buf, uint8_t *byte);
+uint8_t ringbuf_peek(ringbuf_t *buf, uint8_t *byte);
+uint8_t ringbuf_getCount(ringbuf_t *buf);
+uint8_t ringbuf_getFree(ringbuf_t *buf);
+
+#endif // _RINGBUF_H
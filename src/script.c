@@ -0,0 +1,320 @@
+#include "script.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPERS 2
+#define MAX_STEPPER_POS 199
+
+/*******************************************************************************
+* Private Typedefs
+*******************************************************************************/
+typedef enum script_wait_t {
+  SCRIPT_WAIT_NONE,
+  SCRIPT_WAIT_MOVE,
+  SCRIPT_WAIT_DWELL,
+  SCRIPT_WAIT_AXIS
+} script_wait_t;
+
+// everything a script needs to pick up where it left off lives here, so it
+// can yield at any wait and resume on the next tick without a stack
+typedef struct script_t {
+  const uint8_t *program;
+  uint8_t length;
+  uint8_t pc;
+  script_status_t status;
+
+  script_wait_t wait;
+  uint16_t dwell_left;
+  stepper_descriptor_t wait_axis;
+  uint8_t waits_reached;
+
+  // the pc of each loop being counted and the passes it has left
+  uint8_t depth;
+  uint8_t loop_pc[SCRIPT_MAX_LOOPS];
+  uint8_t loop_left[SCRIPT_MAX_LOOPS];
+} script_t;
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static script_t scripts[MAX_STEPPERS];
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static uint8_t _getOpSize(uint8_t op);
+static uint8_t _isValid(
+  stepper_descriptor_t handle,
+  const uint8_t *program,
+  uint8_t length
+);
+static uint8_t _isBoundary(const uint8_t *program, uint8_t pc);
+static uint8_t _isIdle(stepper_descriptor_t handle);
+static uint8_t _isCaughtUp(script_t *script);
+static void _run(stepper_descriptor_t handle);
+static void _loop(script_t *script, uint8_t times, uint8_t back);
+static void _moveTo(stepper_descriptor_t handle, uint8_t pos, int8_t dir);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// the stepper is put in NORMAL mode, the script drives it from here on
+script_err_t script_start(
+  stepper_descriptor_t handle,
+  const uint8_t *program,
+  uint8_t length
+) {
+  script_err_t err = SCRIPT_ERR_NONE;
+
+  if (handle >= MAX_STEPPERS
+    || stepper_getStatus(handle) == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = SCRIPT_ERR_HANDLE_INVALID;
+  } else if (!_isValid(handle, program, length)) {
+    err = SCRIPT_ERR_OPTION_INVALID;
+  } else {
+    scripts[handle].program = program;
+    scripts[handle].length = length;
+    scripts[handle].pc = 0;
+    scripts[handle].wait = SCRIPT_WAIT_NONE;
+    scripts[handle].waits_reached = 0;
+    scripts[handle].depth = 0;
+    stepper_setMode(handle, STEPPER_MODE_NORMAL);
+    scripts[handle].status = SCRIPT_STATUS_RUNNING;
+  }
+
+  return err;
+}
+
+script_err_t script_stop(stepper_descriptor_t handle) {
+  script_err_t err = SCRIPT_ERR_NONE;
+
+  if (handle >= MAX_STEPPERS) {
+    err = SCRIPT_ERR_HANDLE_INVALID;
+  } else {
+    scripts[handle].status = SCRIPT_STATUS_IDLE;
+  }
+
+  return err;
+}
+
+// call from the step timer isr before stepper_stepEngage(). runs the script
+// until it has to wait for something, or for SCRIPT_OPS_PER_TICK instructions
+script_err_t script_tick(stepper_descriptor_t handle) {
+  script_err_t err = SCRIPT_ERR_NONE;
+  script_t *script;
+  uint8_t ops = 0;
+
+  if (handle >= MAX_STEPPERS
+    || stepper_getStatus(handle) == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = SCRIPT_ERR_HANDLE_INVALID;
+  } else if (scripts[handle].status == SCRIPT_STATUS_RUNNING) {
+    script = &scripts[handle];
+
+    if (script->wait == SCRIPT_WAIT_DWELL) {
+      script->dwell_left--;
+      if (script->dwell_left == 0) {
+        script->wait = SCRIPT_WAIT_NONE;
+      }
+    } else if (script->wait == SCRIPT_WAIT_MOVE) {
+      if (_isIdle(handle)) {
+        script->wait = SCRIPT_WAIT_NONE;
+      }
+    } else if (script->wait == SCRIPT_WAIT_AXIS) {
+      if (_isCaughtUp(script)) {
+        script->wait = SCRIPT_WAIT_NONE;
+      }
+    }
+
+    while (script->status == SCRIPT_STATUS_RUNNING
+      && script->wait == SCRIPT_WAIT_NONE
+      && ops < SCRIPT_OPS_PER_TICK
+    ) {
+      _run(handle);
+      ops++;
+    }
+  }
+
+  return err;
+}
+
+script_status_t script_getStatus(stepper_descriptor_t handle) {
+  return scripts[handle].status;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+// opcode plus operands, 0 for an unknown opcode
+static uint8_t _getOpSize(uint8_t op) {
+  uint8_t size = 0;
+
+  switch (op) {
+    case SCRIPT_OP_END:
+      size = 1;
+      break;
+    case SCRIPT_OP_MOVE_TO:
+    case SCRIPT_OP_MOVE_BY:
+    case SCRIPT_OP_SPEED:
+    case SCRIPT_OP_STEP_SIZE:
+    case SCRIPT_OP_WAIT:
+      size = 2;
+      break;
+    case SCRIPT_OP_DWELL:
+    case SCRIPT_OP_LOOP:
+      size = 3;
+      break;
+  }
+
+  return size;
+}
+
+static uint8_t _isValid(
+  stepper_descriptor_t handle,
+  const uint8_t *program,
+  uint8_t length
+) {
+  uint8_t valid = 1;
+  uint8_t pc = 0;
+  uint8_t size;
+  const uint8_t *op;
+
+  while (pc < length && valid) {
+    op = &program[pc];
+    size = _getOpSize(op[0]);
+    if (size == 0 || size > length - pc) {
+      valid = 0;
+    } else if (op[0] == SCRIPT_OP_MOVE_TO) {
+      valid = (op[1] <= MAX_STEPPER_POS);
+    } else if (op[0] == SCRIPT_OP_STEP_SIZE) {
+      valid = (op[1] <= STEPPER_STEP_SIZE_SIXTEENTH);
+    } else if (op[0] == SCRIPT_OP_WAIT) {
+      valid = (op[1] < MAX_STEPPERS && op[1] != handle);
+    } else if (op[0] == SCRIPT_OP_DWELL) {
+      valid = (op[1] != 0 || op[2] != 0);
+    } else if (op[0] == SCRIPT_OP_LOOP) {
+      valid = (op[2] != 0 && op[2] <= pc && _isBoundary(program, pc - op[2]));
+    }
+    pc += size;
+  }
+
+  return valid;
+}
+
+// whether an instruction starts at pc rather than one of its operands
+static uint8_t _isBoundary(const uint8_t *program, uint8_t pc) {
+  uint8_t i = 0;
+
+  while (i < pc) {
+    i += _getOpSize(program[i]);
+  }
+
+  return i == pc;
+}
+
+static uint8_t _isIdle(stepper_descriptor_t handle) {
+  return stepper_getPos(handle) == stepper_getDesiredPos1(handle)
+    && stepper_getBacklashPending(handle) == 0
+    && stepper_getCorrectionPending(handle) == 0;
+}
+
+// the other axis has stopped and its script has got to at least as many waits
+// as this one, or has none running. two scripts waiting on each other meet
+static uint8_t _isCaughtUp(script_t *script) {
+  script_t *other = &scripts[script->wait_axis];
+
+  return _isIdle(script->wait_axis)
+    && (other->status != SCRIPT_STATUS_RUNNING
+    || (int8_t)(other->waits_reached - script->waits_reached) >= 0);
+}
+
+static void _run(stepper_descriptor_t handle) {
+  script_t *script = &scripts[handle];
+  const uint8_t *op = &script->program[script->pc];
+  int16_t pos;
+
+  if (script->pc >= script->length || op[0] == SCRIPT_OP_END) {
+    script->status = SCRIPT_STATUS_DONE;
+  } else {
+    script->pc += _getOpSize(op[0]);
+    switch (op[0]) {
+      case SCRIPT_OP_MOVE_TO:
+        pos = stepper_getPos(handle);
+        _moveTo(handle, op[1], (op[1] > pos) ? 1 : -1);
+        break;
+      case SCRIPT_OP_MOVE_BY:
+        pos = stepper_getPos(handle) + (int8_t)op[1];
+        if (pos < 0) {
+          pos += MAX_STEPPER_POS + 1;
+        } else if (pos > MAX_STEPPER_POS) {
+          pos -= MAX_STEPPER_POS + 1;
+        }
+        _moveTo(handle, (uint8_t)pos, ((int8_t)op[1] > 0) ? 1 : -1);
+        break;
+      case SCRIPT_OP_DWELL:
+        script->dwell_left = op[1] | ((uint16_t)op[2] << 8);
+        script->wait = SCRIPT_WAIT_DWELL;
+        break;
+      case SCRIPT_OP_SPEED:
+        stepper_setSpeed(handle, op[1]);
+        break;
+      case SCRIPT_OP_STEP_SIZE:
+        stepper_setStepSize(handle, (stepper_step_size_t)op[1]);
+        break;
+      case SCRIPT_OP_WAIT:
+        script->waits_reached++;
+        script->wait_axis = op[1];
+        script->wait = SCRIPT_WAIT_AXIS;
+        break;
+      case SCRIPT_OP_LOOP:
+        _loop(script, op[1], op[2]);
+        break;
+    }
+  }
+}
+
+// the body has already run once by the time the loop instruction is reached,
+// so times counts every pass including that one
+static void _loop(script_t *script, uint8_t times, uint8_t back) {
+  uint8_t loop_pc = script->pc - _getOpSize(SCRIPT_OP_LOOP);
+  uint8_t top = script->depth - 1;
+
+  if (script->depth == 0 || script->loop_pc[top] != loop_pc) {
+    if (times == 1) {
+      // nothing left to repeat
+    } else if (script->depth >= SCRIPT_MAX_LOOPS) {
+      script->status = SCRIPT_STATUS_FAULT;
+    } else {
+      top = script->depth++;
+      script->loop_pc[top] = loop_pc;
+      // forever loops keep 0 and are never popped
+      script->loop_left[top] = (times == 0) ? 0 : times - 1;
+      script->pc = loop_pc - back;
+    }
+  } else if (script->loop_left[top] == 0) {
+    script->pc = loop_pc - back;
+  } else {
+    script->loop_left[top]--;
+    if (script->loop_left[top] == 0) {
+      script->depth--;
+    } else {
+      script->pc = loop_pc - back;
+    }
+  }
+}
+
+static void _moveTo(stepper_descriptor_t handle, uint8_t pos, int8_t dir) {
+  script_t *script = &scripts[handle];
+
+  if (pos != stepper_getPos(handle)) {
+    if (dir > 0) {
+      stepper_setDir(handle, STEPPER_DIR_FORWARD);
+    } else {
+      stepper_setDir(handle, STEPPER_DIR_REVERSE);
+    }
+    stepper_setPos(handle, pos, stepper_getDesiredPos2(handle));
+    script->wait = SCRIPT_WAIT_MOVE;
+  }
+}
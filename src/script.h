@@ -0,0 +1,54 @@
+#ifndef _SCRIPT_H
+#define _SCRIPT_H
+
+#include <stdint.h>
+#include "stepper.h"
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+#define SCRIPT_MAX_LOOPS 2
+// instructions run per tick at most, keeps the isr short even for a loop
+// with nothing in it that waits
+#define SCRIPT_OPS_PER_TICK 4
+
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum script_err_t {
+  SCRIPT_ERR_NONE,
+  SCRIPT_ERR_HANDLE_INVALID,
+  SCRIPT_ERR_OPTION_INVALID
+} script_err_t;
+
+typedef enum script_status_t {
+  SCRIPT_STATUS_IDLE,
+  SCRIPT_STATUS_RUNNING,
+  SCRIPT_STATUS_DONE,
+  SCRIPT_STATUS_FAULT
+} script_status_t;
+
+// a program is a byte array of opcodes, each followed by its operands
+typedef enum script_op_t {
+  SCRIPT_OP_END,        //
+  SCRIPT_OP_MOVE_TO,    // pos
+  SCRIPT_OP_MOVE_BY,    // steps as int8
+  SCRIPT_OP_DWELL,      // ticks low byte, ticks high byte
+  SCRIPT_OP_SPEED,      // speed
+  SCRIPT_OP_STEP_SIZE,  // step_size
+  SCRIPT_OP_WAIT,       // stepper handle
+  SCRIPT_OP_LOOP        // times (0 forever), bytes back to the loop start
+} script_op_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+script_err_t script_start(
+  stepper_descriptor_t handle,
+  const uint8_t *program,
+  uint8_t length
+);
+script_err_t script_stop(stepper_descriptor_t handle);
+script_err_t script_tick(stepper_descriptor_t handle);
+script_status_t script_getStatus(stepper_descriptor_t handle);
+
+#endif // _SCRIPT_H
@@ -0,0 +1,428 @@
+#include "scurve.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define SCURVE_SEGMENT_DONE SCURVE_NUM_SEGMENTS
+#define SCURVE_MAX_TICK_HZ 0x00FFFFFFUL
+#define SCURVE_SPEED_SEARCH_BITS 16
+#define SCURVE_INTERVAL_BITS 24
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+// jerk applied in each of the seven segments: jerk up, constant accel, jerk
+// down, cruise, then the mirror image for the deceleration
+static const int8_t jerk_sign[SCURVE_NUM_SEGMENTS] = {1, 0, -1, 0, -1, 0, 1};
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static uint32_t _isqrt(uint64_t value);
+static uint32_t _velocity(uint32_t v0, int32_t a0, int32_t j, uint32_t t);
+static int32_t _accel(int32_t a0, int32_t j, uint32_t t);
+static uint32_t _accelPhase(
+  scurve_attr_t *config,
+  int32_t j,
+  uint16_t peak_speed,
+  uint32_t *jerk_ticks,
+  uint32_t *accel_ticks
+);
+static void _startSegment(scurve_t *profile, uint8_t segment);
+static void _integrate(
+  uint32_t *v,
+  int32_t *a,
+  uint16_t *a_frac,
+  int32_t j,
+  uint16_t dt
+);
+static void _advance(scurve_t *profile, uint16_t dt);
+static uint32_t _sample(scurve_t *profile, uint16_t dt);
+static uint16_t _halfTicks(uint32_t interval);
+static uint32_t _divisor(scurve_t *profile, uint32_t v);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// velocities are kept as Q16.16 steps/s, acceleration as Q16.16 steps/s per
+// tick and jerk as Q0.32 steps/s per tick^2. the 64 bit maths only runs here
+// and once per segment, a step only integrates the speed in 32 bits and does
+// a 32 bit divide when the speed has changed
+scurve_err_t scurve_plan(
+  scurve_t *profile,
+  scurve_attr_t config,
+  uint16_t steps
+) {
+  scurve_err_t err = SCURVE_ERR_NONE;
+  uint64_t a;
+  uint64_t j;
+  uint32_t slow_ticks;
+  uint32_t jerk_ticks;
+  uint32_t accel_ticks;
+  uint32_t accel_steps;
+  uint32_t lo;
+  uint32_t hi;
+  uint32_t mid;
+  uint8_t i;
+
+  if (config.tick_hz == 0
+    || config.tick_hz > SCURVE_MAX_TICK_HZ
+    || config.min_speed == 0
+    || config.max_speed < config.min_speed
+    || config.max_accel == 0
+    || config.max_jerk == 0
+  ) {
+    err = SCURVE_ERR_OPTION_INVALID;
+  } else {
+    // the slowest step has to fit the 16 bit interval, and the speed change
+    // over it the 32 bit integration of twice the acceleration
+    slow_ticks = config.tick_hz / config.min_speed;
+    a = (((uint64_t)config.max_accel << 16) / config.tick_hz) + 1;
+    j = ((uint64_t)config.max_jerk << 32)
+      / ((uint64_t)config.tick_hz * config.tick_hz);
+    if (slow_ticks > UINT16_MAX
+      || 2 * a * (slow_ticks + 1) > INT32_MAX
+      || j == 0
+      || j > INT32_MAX
+    ) {
+      err = SCURVE_ERR_OPTION_INVALID;
+    }
+  }
+
+  if (err == SCURVE_ERR_NONE) {
+    // find the fastest peak speed whose accel and decel phases fit the move
+    lo = config.min_speed;
+    hi = config.max_speed;
+    accel_steps = _accelPhase(
+      &config, (int32_t)j, hi, &jerk_ticks, &accel_ticks
+    );
+    if (((uint32_t)steps << 8) < 2 * accel_steps) {
+      for (i=0;i<SCURVE_SPEED_SEARCH_BITS && lo < hi;i++) {
+        mid = (lo + hi + 1) / 2;
+        if (2 * _accelPhase(
+          &config, (int32_t)j, mid, &jerk_ticks, &accel_ticks
+        ) <= ((uint32_t)steps << 8)) {
+          lo = mid;
+        } else {
+          hi = mid - 1;
+        }
+      }
+      accel_steps = _accelPhase(
+        &config, (int32_t)j, lo, &jerk_ticks, &accel_ticks
+      );
+
+      // a move too short for a jerk segment as long as its first step runs
+      // at min_speed throughout
+      if (jerk_ticks < slow_ticks) {
+        accel_steps = _accelPhase(
+          &config, (int32_t)j, config.min_speed, &jerk_ticks, &accel_ticks
+        );
+      }
+    } else if (config.max_speed > config.min_speed
+      && jerk_ticks < slow_ticks
+    ) {
+      // the steps at either end would each span several segments
+      err = SCURVE_ERR_OPTION_INVALID;
+    }
+  }
+
+  if (err == SCURVE_ERR_NONE) {
+    profile->tick_hz = config.tick_hz;
+    profile->min_speed = (uint32_t)config.min_speed << 16;
+    profile->max_speed = (uint32_t)config.max_speed << 16;
+    profile->steps_left = steps;
+    profile->ramp_steps = accel_steps;
+    profile->jerk = (int32_t)j;
+    profile->frac = 0;
+    profile->last = (uint16_t)(config.tick_hz / config.min_speed);
+
+    // interval_q8 = (tick_hz << 24) / v, split so both sides fit 32 bits
+    profile->shift = 1;
+    while ((config.tick_hz >> (profile->shift + 8)) != 0) {
+      profile->shift++;
+    }
+    profile->numerator = config.tick_hz
+      << (SCURVE_INTERVAL_BITS - profile->shift);
+    profile->divisor = 0;
+    profile->interval = 0;
+
+    profile->seg_ticks[0] = jerk_ticks;
+    profile->seg_ticks[1] = accel_ticks;
+    profile->seg_ticks[2] = jerk_ticks;
+    // sized once the cruise starts
+    profile->seg_ticks[3] = 0;
+    profile->seg_ticks[4] = jerk_ticks;
+    profile->seg_ticks[5] = accel_ticks;
+    profile->seg_ticks[6] = jerk_ticks;
+
+    profile->v0 = profile->min_speed;
+    profile->a0 = 0;
+    profile->elapsed = 0;
+    _startSegment(profile, 0);
+  }
+
+  return err;
+}
+
+// returns the number of ticks to wait before the next step, or 0 once the
+// planned number of steps has been issued
+uint16_t scurve_nextInterval(scurve_t *profile) {
+  uint32_t interval;
+  uint16_t ticks = 0;
+
+  if (profile->steps_left > 0) {
+    // sample the speed half way through the step. the previous interval is
+    // the first guess at how long the step is, the interval found there a
+    // closer one
+    interval = _sample(profile, profile->last / 2);
+    interval = _sample(profile, _halfTicks(interval));
+
+    interval += profile->frac;
+    profile->frac = (uint8_t)(interval & 0xFF);
+    interval >>= 8;
+    if (interval == 0) {
+      interval = 1;
+    } else if (interval > UINT16_MAX) {
+      interval = UINT16_MAX;
+    }
+    ticks = (uint16_t)interval;
+    profile->last = ticks;
+
+    _advance(profile, ticks);
+    profile->steps_left--;
+  }
+
+  return ticks;
+}
+
+uint16_t scurve_getStepsLeft(scurve_t *profile) {
+  return profile->steps_left;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static uint32_t _isqrt(uint64_t value) {
+  uint64_t root = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return (uint32_t)root;
+}
+
+static uint32_t _velocity(uint32_t v0, int32_t a0, int32_t j, uint32_t t) {
+  int64_t v;
+
+  v = (int64_t)v0
+    + (int64_t)a0 * t
+    + (((int64_t)j * t * t) >> 17);
+
+  if (v < 0) {
+    v = 0;
+  } else if (v > UINT32_MAX) {
+    v = UINT32_MAX;
+  }
+
+  return (uint32_t)v;
+}
+
+static int32_t _accel(int32_t a0, int32_t j, uint32_t t) {
+  return a0 + (int32_t)(((int64_t)j * t) >> 16);
+}
+
+// plans the jerk and constant acceleration segment lengths needed to get
+// from min_speed to peak_speed and returns the Q8 steps the phase covers
+static uint32_t _accelPhase(
+  scurve_attr_t *config,
+  int32_t j,
+  uint16_t peak_speed,
+  uint32_t *jerk_ticks,
+  uint32_t *accel_ticks
+) {
+  uint64_t dv = peak_speed - config->min_speed;
+  uint64_t tick_hz = config->tick_hz;
+  uint32_t v;
+  int32_t a;
+
+  if (dv * config->max_jerk
+    <= (uint64_t)config->max_accel * config->max_accel
+  ) {
+    // max_accel is never reached, the phase is two jerk segments
+    *jerk_ticks = _isqrt((dv * tick_hz * tick_hz) / config->max_jerk);
+    *accel_ticks = 0;
+  } else {
+    *jerk_ticks = (uint32_t)(
+      ((uint64_t)config->max_accel * tick_hz) / config->max_jerk
+    );
+    *accel_ticks = (uint32_t)((dv * tick_hz) / config->max_accel)
+      - *jerk_ticks;
+  }
+
+  // walk the segments exactly as the step generator will so the distance
+  // matches the quantised segment lengths
+  v = _velocity((uint32_t)config->min_speed << 16, 0, j, *jerk_ticks);
+  a = _accel(0, j, *jerk_ticks);
+  v = _velocity(v, a, 0, *accel_ticks);
+  v = _velocity(v, a, -j, *jerk_ticks);
+
+  // the phase is symmetric so the mean speed is halfway between its ends
+  return (uint32_t)(
+    ((uint64_t)(2 * *jerk_ticks + *accel_ticks)
+    * (((uint32_t)config->min_speed << 16) / 2 + v / 2))
+    / (tick_hz << 8)
+  );
+}
+
+static void _startSegment(scurve_t *profile, uint8_t segment) {
+  uint32_t t;
+  int64_t cruise;
+
+  if (segment > 0) {
+    t = profile->seg_ticks[segment - 1];
+    profile->v0 = _velocity(profile->v0, profile->a0, profile->j, t);
+    profile->a0 = _accel(profile->a0, profile->j, t);
+  }
+
+  // cruise and the tail after the profile have no acceleration, snap it so
+  // rounding in the jerk segments can't make the speed drift
+  if (segment == 3 || segment == 4 || segment == SCURVE_SEGMENT_DONE) {
+    profile->a0 = 0;
+  }
+
+  // the cruise is sized from the steps actually left, less the one in
+  // progress, at the rounded interval the steps will use. the ramp's timing
+  // error and the interval rounding then can't cut the decel short
+  if (segment == 3) {
+    cruise = ((int64_t)(profile->steps_left - 1) << 8) - profile->ramp_steps;
+    profile->seg_ticks[3] = 0;
+    if (cruise > 0) {
+      profile->seg_ticks[3] = (uint32_t)(
+        (cruise * (profile->numerator / _divisor(profile, profile->v0))) >> 16
+      );
+    }
+  }
+
+  profile->segment = segment;
+  if (segment < SCURVE_SEGMENT_DONE) {
+    profile->j = profile->jerk * jerk_sign[segment];
+  } else {
+    profile->j = 0;
+  }
+
+  profile->v = profile->v0;
+  profile->a = profile->a0;
+  profile->a_frac = 0;
+}
+
+// moves the profile forward dt ticks. the integration stops at each segment
+// boundary and the next segment starts from its exact speed, so a step longer
+// than a segment can't carry one segment's jerk into the next
+static void _advance(scurve_t *profile, uint16_t dt) {
+  while (profile->segment < SCURVE_SEGMENT_DONE
+    && dt >= profile->seg_ticks[profile->segment] - profile->elapsed
+  ) {
+    dt -= (uint16_t)(profile->seg_ticks[profile->segment] - profile->elapsed);
+    profile->elapsed = 0;
+    _startSegment(profile, profile->segment + 1);
+  }
+
+  if (profile->segment < SCURVE_SEGMENT_DONE) {
+    profile->elapsed += dt;
+  }
+  _integrate(&profile->v, &profile->a, &profile->a_frac, profile->j, dt);
+}
+
+// moves v and a forward dt ticks under constant jerk. a keeps 16 extra
+// fraction bits so rounding doesn't build up over a segment, and v takes the
+// mean of the old and new acceleration, which is exact for constant jerk
+static void _integrate(
+  uint32_t *v,
+  int32_t *a,
+  uint16_t *a_frac,
+  int32_t j,
+  uint16_t dt
+) {
+  uint32_t mag = (j < 0) ? (uint32_t)0 - (uint32_t)j : (uint32_t)j;
+  uint32_t hi = (mag >> 16) * dt;
+  uint32_t lo = (mag & 0xFFFF) * dt;
+  int32_t a_old = *a;
+  uint16_t frac_old = *a_frac;
+  int32_t dv;
+
+  if (j >= 0) {
+    lo += *a_frac;
+    *a += (int32_t)(hi + (lo >> 16));
+    *a_frac = (uint16_t)(lo & 0xFFFF);
+  } else {
+    hi += lo >> 16;
+    lo &= 0xFFFF;
+    if (*a_frac < lo) {
+      hi++;
+    }
+    *a -= (int32_t)hi;
+    *a_frac = (uint16_t)(*a_frac - lo);
+  }
+
+  // twice the speed change, halved once the fractions are folded in
+  dv = ((a_old + *a) * (int32_t)dt
+    + (int32_t)(((((uint32_t)frac_old + *a_frac) >> 1) * dt) >> 15)) / 2;
+
+  if (dv < 0 && (uint32_t)-dv > *v) {
+    *v = 0;
+  } else if (dv > 0 && (uint32_t)dv > UINT32_MAX - *v) {
+    *v = UINT32_MAX;
+  } else {
+    *v += (uint32_t)dv;
+  }
+}
+
+// returns the Q8 interval for the speed dt ticks ahead, held between
+// min_speed and max_speed. the divide is skipped while the speed holds
+static uint32_t _sample(scurve_t *profile, uint16_t dt) {
+  scurve_t ahead = *profile;
+  uint32_t v;
+  uint32_t divisor;
+
+  _advance(&ahead, dt);
+  v = ahead.v;
+  if (v < profile->min_speed) {
+    v = profile->min_speed;
+  } else if (v > profile->max_speed) {
+    v = profile->max_speed;
+  }
+
+  divisor = _divisor(profile, v);
+  if (divisor != profile->divisor) {
+    profile->divisor = divisor;
+    profile->interval = profile->numerator / divisor;
+  }
+
+  return profile->interval;
+}
+
+static uint16_t _halfTicks(uint32_t interval) {
+  interval >>= 9;
+  if (interval > UINT16_MAX) {
+    interval = UINT16_MAX;
+  }
+
+  return (uint16_t)interval;
+}
+
+// the speed scaled down to the interval divide. it is rounded, truncating
+// makes every interval long and the move lag
+static uint32_t _divisor(scurve_t *profile, uint32_t v) {
+  return (v >> profile->shift) + ((v >> (profile->shift - 1)) & 1);
+}
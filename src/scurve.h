@@ -0,0 +1,71 @@
+#ifndef _SCURVE_H
+#define _SCURVE_H
+
+#include <stdint.h>
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+#define SCURVE_NUM_SEGMENTS 7
+
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum scurve_err_t {
+  SCURVE_ERR_NONE,
+  SCURVE_ERR_OPTION_INVALID
+} scurve_err_t;
+
+// all rates are in steps per second, the profile is symmetric so the move
+// starts and ends at min_speed
+typedef struct scurve_attr_t {
+  uint32_t tick_hz;
+  uint16_t min_speed;
+  uint16_t max_speed;
+  uint32_t max_accel;
+  uint32_t max_jerk;
+} scurve_attr_t;
+
+typedef struct scurve_t {
+  uint32_t tick_hz;
+  uint32_t min_speed;
+  uint32_t max_speed;
+  uint16_t steps_left;
+  uint8_t segment;
+  uint32_t seg_ticks[SCURVE_NUM_SEGMENTS];
+  int32_t jerk;
+  // Q8 steps covered by the accel phase, and again by the decel
+  uint32_t ramp_steps;
+
+  // coefficients of the active segment, refreshed when a segment starts
+  uint32_t elapsed;
+  uint32_t v0;
+  int32_t a0;
+  int32_t j;
+  uint16_t last;
+  uint8_t frac;
+
+  // speed and acceleration at elapsed, stepped forward in 32 bits
+  uint32_t v;
+  int32_t a;
+  uint16_t a_frac;
+
+  // tick_hz and the speed are scaled by shift so the interval divide fits
+  // 32 bits, the last result is reused while cruising
+  uint32_t numerator;
+  uint8_t shift;
+  uint32_t divisor;
+  uint32_t interval;
+} scurve_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+scurve_err_t scurve_plan(
+  scurve_t *profile,
+  scurve_attr_t config,
+  uint16_t steps
+);
+uint16_t scurve_nextInterval(scurve_t *profile);
+uint16_t scurve_getStepsLeft(scurve_t *profile);
+
+#endif // _SCURVE_H
@@ -0,0 +1,241 @@
+#include "shaper.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define SHAPER_ONE 32768UL
+#define SHAPER_Q16_ONE 65536UL
+#define SHAPER_PI_Q16 205887UL
+#define SHAPER_LN2_Q16 45426UL
+#define SHAPER_HISTORY_MASK (SHAPER_HISTORY - 1)
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static uint32_t _isqrt(uint64_t value);
+static uint32_t _expNeg(uint32_t x);
+static int16_t _commandedAt(shaper_t *shaper, uint16_t delay);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+shaper_err_t shaper_init(shaper_t *shaper, shaper_attr_t config) {
+  shaper_err_t err = SHAPER_ERR_NONE;
+  uint32_t root;
+  uint32_t x;
+  uint32_t k;
+  uint64_t denom;
+  uint64_t period;
+  uint16_t max_delay;
+  uint8_t i;
+
+  if (config.tick_hz == 0
+    || config.freq_dhz == 0
+    || config.damping_pm >= 1000
+    || (config.type != SHAPER_TYPE_NONE
+      && config.type != SHAPER_TYPE_ZV
+      && config.type != SHAPER_TYPE_ZVD)
+  ) {
+    err = SHAPER_ERR_OPTION_INVALID;
+  } else {
+    // sqrt(1 - damping^2), the damping factor K = exp(-damping * pi / root)
+    // and the damped period, all Q16
+    root = _isqrt(
+      (((uint64_t)1000000 - (uint32_t)config.damping_pm * config.damping_pm)
+      << 32) / 1000000
+    );
+    x = (uint32_t)(
+      ((uint64_t)config.damping_pm * SHAPER_Q16_ONE / 1000 * SHAPER_PI_Q16)
+      / root
+    );
+    k = _expNeg(x);
+    period = ((uint64_t)config.tick_hz * 10 * SHAPER_Q16_ONE)
+      / ((uint64_t)config.freq_dhz * root);
+
+    shaper->delay[0] = 0;
+    if (config.type == SHAPER_TYPE_NONE) {
+      shaper->num_impulses = 1;
+      shaper->amplitude[0] = SHAPER_ONE;
+      period = 0;
+    } else if (config.type == SHAPER_TYPE_ZV) {
+      shaper->num_impulses = 2;
+      shaper->amplitude[0] = (uint16_t)(
+        (SHAPER_ONE * SHAPER_Q16_ONE) / (SHAPER_Q16_ONE + k)
+      );
+      shaper->amplitude[1] = SHAPER_ONE - shaper->amplitude[0];
+      shaper->delay[1] = (uint16_t)(period / 2);
+      period /= 2;
+    } else {
+      shaper->num_impulses = 3;
+      denom = (uint64_t)(SHAPER_Q16_ONE + k) * (SHAPER_Q16_ONE + k);
+      shaper->amplitude[0] = (uint16_t)(
+        ((uint64_t)SHAPER_ONE << 32) / denom
+      );
+      shaper->amplitude[1] = (uint16_t)(
+        ((uint64_t)SHAPER_ONE * 2 * k * SHAPER_Q16_ONE) / denom
+      );
+      shaper->amplitude[2] = SHAPER_ONE
+        - shaper->amplitude[0]
+        - shaper->amplitude[1];
+      shaper->delay[1] = (uint16_t)(period / 2);
+      shaper->delay[2] = (uint16_t)period;
+    }
+
+    if (period > UINT16_MAX) {
+      err = SHAPER_ERR_OPTION_INVALID;
+    }
+  }
+
+  if (err == SHAPER_ERR_NONE) {
+    // pick a sample period so the longest delay still has a sample behind it
+    // to interpolate against
+    max_delay = shaper->delay[shaper->num_impulses - 1];
+    shaper->sample_shift = 0;
+    while (((uint32_t)1 << shaper->sample_shift) * (SHAPER_HISTORY - 2)
+      < max_delay
+    ) {
+      shaper->sample_shift++;
+    }
+
+    for (i=0;i<SHAPER_HISTORY;i++) {
+      shaper->history[i] = 0;
+    }
+    shaper->head = 0;
+    shaper->phase = 0;
+    shaper->commanded = 0;
+    shaper->shaped = 0;
+  }
+
+  return err;
+}
+
+// records a step issued by the motion profile, +1 forward and -1 reverse
+void shaper_push(shaper_t *shaper, int8_t step) {
+  shaper->commanded += step;
+}
+
+// call once per tick, returns the step the axis should take this tick
+int8_t shaper_tick(shaper_t *shaper) {
+  int32_t offset = 0;
+  int8_t step = 0;
+  uint8_t i;
+
+  shaper->phase++;
+  if (shaper->phase >= ((uint16_t)1 << shaper->sample_shift)) {
+    shaper->phase = 0;
+    shaper->head = (shaper->head - 1) & SHAPER_HISTORY_MASK;
+    shaper->history[shaper->head] = shaper->commanded;
+  }
+
+  // weigh each impulse against the position already emitted so the sum
+  // stays small and int16 wrap-around doesn't matter
+  for (i=0;i<shaper->num_impulses;i++) {
+    offset += (int32_t)shaper->amplitude[i]
+      * (int16_t)(_commandedAt(shaper, shaper->delay[i]) - shaper->shaped);
+  }
+
+  if (offset >= (int32_t)(SHAPER_ONE / 2)) {
+    shaper->shaped++;
+    step = 1;
+  } else if (offset <= -(int32_t)(SHAPER_ONE / 2)) {
+    shaper->shaped--;
+    step = -1;
+  }
+
+  return step;
+}
+
+// call from the step timer isr ahead of stepper_stepEngage(). the step the
+// shaper releases this tick becomes a one step move of the motor
+shaper_err_t shaper_tickStepper(
+  shaper_t *shaper,
+  stepper_descriptor_t handle
+) {
+  shaper_err_t err = SHAPER_ERR_NONE;
+  int8_t step;
+
+  if (stepper_getStatus(handle) == STEPPER_STATUS_AVAILABLE) {
+    err = SHAPER_ERR_HANDLE_INVALID;
+  } else {
+    step = shaper_tick(shaper);
+    if (step != 0) {
+      stepper_move(handle, step);
+    }
+  }
+
+  return err;
+}
+
+// steps pushed by the profile that the shaper hasn't released yet
+int16_t shaper_getLag(shaper_t *shaper) {
+  return shaper->commanded - shaper->shaped;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static uint32_t _isqrt(uint64_t value) {
+  uint64_t root = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return (uint32_t)root;
+}
+
+// exp(-x) for Q16 x, split into a power of two and a short series over the
+// remainder which is always below ln(2)
+static uint32_t _expNeg(uint32_t x) {
+  uint32_t n = x / SHAPER_LN2_Q16;
+  uint32_t r = x - n * SHAPER_LN2_Q16;
+  uint32_t result;
+
+  if (n >= 16) {
+    result = 0;
+  } else {
+    result = SHAPER_Q16_ONE - (r / 5);
+    result = SHAPER_Q16_ONE - ((r * (uint64_t)result) >> 16) / 4;
+    result = SHAPER_Q16_ONE - ((r * (uint64_t)result) >> 16) / 3;
+    result = SHAPER_Q16_ONE - ((r * (uint64_t)result) >> 16) / 2;
+    result = SHAPER_Q16_ONE - ((r * (uint64_t)result) >> 16);
+    result >>= n;
+  }
+
+  return result;
+}
+
+// commanded position delay ticks ago, interpolated between history samples
+static int16_t _commandedAt(shaper_t *shaper, uint16_t delay) {
+  int16_t newer;
+  int16_t older;
+  uint16_t back;
+  uint8_t j;
+  uint16_t frac;
+  int16_t pos;
+
+  if (delay == 0) {
+    pos = shaper->commanded;
+  } else {
+    back = delay - shaper->phase;
+    j = (uint8_t)(back >> shaper->sample_shift);
+    frac = back & (((uint16_t)1 << shaper->sample_shift) - 1);
+    newer = shaper->history[(shaper->head + j) & SHAPER_HISTORY_MASK];
+    older = shaper->history[(shaper->head + j + 1) & SHAPER_HISTORY_MASK];
+    pos = newer - (int16_t)(
+      ((int32_t)(int16_t)(newer - older) * frac) >> shaper->sample_shift
+    );
+  }
+
+  return pos;
+}
@@ -0,0 +1,63 @@
+#ifndef _SHAPER_H
+#define _SHAPER_H
+
+#include <stdint.h>
+#include "stepper.h"
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+#define SHAPER_MAX_IMPULSES 3
+#define SHAPER_HISTORY 16
+
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+typedef enum shaper_err_t {
+  SHAPER_ERR_NONE,
+  SHAPER_ERR_OPTION_INVALID,
+  SHAPER_ERR_HANDLE_INVALID
+} shaper_err_t;
+
+typedef enum shaper_type_t {
+  SHAPER_TYPE_NONE,
+  SHAPER_TYPE_ZV,
+  SHAPER_TYPE_ZVD
+} shaper_type_t;
+
+// freq_dhz is the resonance to cancel in tenths of a hertz and damping_pm
+// its damping ratio in thousandths
+typedef struct shaper_attr_t {
+  shaper_type_t type;
+  uint32_t tick_hz;
+  uint16_t freq_dhz;
+  uint16_t damping_pm;
+} shaper_attr_t;
+
+typedef struct shaper_t {
+  uint8_t num_impulses;
+  uint16_t amplitude[SHAPER_MAX_IMPULSES];
+  uint16_t delay[SHAPER_MAX_IMPULSES];
+
+  // commanded positions sampled every (1 << sample_shift) ticks, newest first
+  int16_t history[SHAPER_HISTORY];
+  uint8_t head;
+  uint8_t sample_shift;
+  uint16_t phase;
+
+  int16_t commanded;
+  int16_t shaped;
+} shaper_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+shaper_err_t shaper_init(shaper_t *shaper, shaper_attr_t config);
+void shaper_push(shaper_t *shaper, int8_t step);
+int8_t shaper_tick(shaper_t *shaper);
+shaper_err_t shaper_tickStepper(
+  shaper_t *shaper,
+  stepper_descriptor_t handle
+);
+int16_t shaper_getLag(shaper_t *shaper);
+
+#endif // _SHAPER_H
@@ -42,12 +42,77 @@ typedef struct stepper_t {
   uint8_t pos;
   stepper_dir_t dir;
   stepper_mode_t mode;
+  uint8_t backlash;
+  uint8_t backlash_pending;
+  uint8_t correction_pending;
+
+  // oscillate turnarounds, hold counts down the ticks before the next step
+  uint8_t ramp_steps;
+  uint8_t dwell_ticks;
+  uint16_t hold;
+  uint8_t travelled;
+  uint8_t leg;
+  const stepper_pair_t *sequence;
+  uint8_t sequence_len;
+  uint8_t sequence_index;
+
+  // idle handling, idle is what has been done to the driver so far and
+  // waking counts down the ticks it is given to come back up
+  uint8_t *current_reg;
+  uint8_t current_mask;
+  uint8_t current_run;
+  uint8_t current_reduced;
+  stepper_idle_t idle_action;
+  uint16_t idle_ticks;
+  uint8_t wake_ticks;
+  stepper_idle_t idle;
+  uint16_t idle_count;
+  uint8_t waking;
+
+  // dir pin timing. with either set the pin is written from the tick,
+  // dir_hold ticks after the last step at the earliest, and the next step
+  // waits dir_setup ticks after that
+  uint8_t dir_setup;
+  uint8_t dir_hold;
+  uint8_t dir_setup_left;
+  uint8_t dir_hold_left;
+  uint8_t dir_pending;
+
+  // set while stepper_step() has the step line raised
+  uint8_t step_high;
 } stepper_t;
 /*******************************************************************************
 * Private Data
 *******************************************************************************/
 static stepper_t steppers[MAX_STEPPERS];
 /*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _setDir(stepper_descriptor_t handle, stepper_dir_t dir);
+static void _setDirState(stepper_descriptor_t handle, stepper_dir_t dir);
+static void _writeDir(stepper_descriptor_t handle);
+static stepper_dir_t _readDir(stepper_descriptor_t handle);
+static void _dirTick(stepper_descriptor_t handle);
+static uint8_t _isBatchValid(
+  const stepper_descriptor_t *handles,
+  uint8_t num_handles
+);
+static void _writeBatch(
+  uint8_t *const *ports,
+  const uint8_t *pins,
+  uint8_t num_pins,
+  uint8_t high_mask
+);
+static void _turnAround(stepper_descriptor_t handle);
+static uint8_t _getRampHold(stepper_descriptor_t handle);
+static uint8_t _engage(stepper_descriptor_t handle);
+static void _release(stepper_descriptor_t handle);
+static void _step(stepper_descriptor_t handle);
+static void _idleTick(stepper_descriptor_t handle);
+static void _wake(stepper_descriptor_t handle);
+static void _clearIdle(stepper_descriptor_t handle);
+static void _writeCurrent(stepper_descriptor_t handle, uint8_t value);
+/*******************************************************************************
 * Public Function Definitions
 *******************************************************************************/
 stepper_err_t stepper_construct(
@@ -104,10 +169,36 @@ stepper_err_t stepper_construct(
 
       steppers[i].status = STEPPER_STATUS_DISABLED;
       steppers[i].mode = STEPPER_MODE_NORMAL;
+      steppers[i].dir = STEPPER_DIR_FORWARD;
+      steppers[i].step_size = STEPPER_STEP_SIZE_FULL;
       steppers[i].speed = config.speed;
       steppers[i].desired_pos_1 = 0;
       steppers[i].desired_pos_2 = 0;
       steppers[i].pos = 0;
+      steppers[i].backlash = 0;
+      steppers[i].backlash_pending = 0;
+      steppers[i].correction_pending = 0;
+      steppers[i].ramp_steps = 0;
+      steppers[i].dwell_ticks = 0;
+      steppers[i].hold = 0;
+      steppers[i].travelled = 0;
+      steppers[i].leg = 0;
+      steppers[i].sequence = 0;
+      steppers[i].sequence_len = 0;
+      steppers[i].sequence_index = 0;
+      steppers[i].current_reg = 0;
+      steppers[i].idle_action = STEPPER_IDLE_NONE;
+      steppers[i].idle_ticks = 0;
+      steppers[i].wake_ticks = 0;
+      steppers[i].idle = STEPPER_IDLE_NONE;
+      steppers[i].idle_count = 0;
+      steppers[i].waking = 0;
+      steppers[i].dir_setup = 0;
+      steppers[i].dir_hold = 0;
+      steppers[i].dir_setup_left = 0;
+      steppers[i].dir_hold_left = 0;
+      steppers[i].dir_pending = 0;
+      steppers[i].step_high = 0;
 
       *handle = i;
 
@@ -129,8 +220,12 @@ stepper_err_t stepper_enable(stepper_descriptor_t handle) {
   if (handle >= MAX_STEPPERS) {
     err = STEPPER_ERR_HANDLE_INVALID;
   } else {
+    if (steppers[handle].status != STEPPER_STATUS_ENABLED) {
+      steppers[handle].waking = steppers[handle].wake_ticks;
+    }
     steppers[handle].status = STEPPER_STATUS_ENABLED;
     *steppers[handle].enable_port &= ~(1 << steppers[handle].enable_pin);
+    _wake(handle);
   }
 
   return err;
@@ -146,6 +241,7 @@ stepper_err_t stepper_disable(stepper_descriptor_t handle) {
   } else {
     steppers[handle].status = STEPPER_STATUS_DISABLED;
     *steppers[handle].enable_port |= (1 << steppers[handle].enable_pin);
+    _clearIdle(handle);
   }
 
   return err;
@@ -242,6 +338,54 @@ stepper_err_t stepper_setPos(
   return err;
 }
 
+// tells the stepper where it already is, e.g. from a position saved before
+// power down, without stepping to get there
+stepper_err_t stepper_seedPos(stepper_descriptor_t handle, uint8_t pos) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+
+  if (handle >= MAX_STEPPERS
+    || steppers[handle].status == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else if (pos > MAX_STEPPER_POS) {
+    err = STEPPER_ERR_POSITION_INVALID;
+  } else {
+    steppers[handle].pos = pos;
+    steppers[handle].desired_pos_1 = pos;
+  }
+
+  return err;
+}
+
+// moves desired_pos_1 on by steps, wrapping round the revolution, and turns
+// the motor towards it
+stepper_err_t stepper_move(stepper_descriptor_t handle, int16_t steps) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+  int16_t pos;
+
+  if (handle >= MAX_STEPPERS
+    || steppers[handle].status == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else {
+    pos = steppers[handle].desired_pos_1 + steps % (MAX_STEPPER_POS + 1);
+    if (pos < 0) {
+      pos += MAX_STEPPER_POS + 1;
+    } else if (pos > MAX_STEPPER_POS) {
+      pos -= MAX_STEPPER_POS + 1;
+    }
+    steppers[handle].desired_pos_1 = (uint8_t)pos;
+
+    if (steps > 0) {
+      _setDir(handle, STEPPER_DIR_FORWARD);
+    } else if (steps < 0) {
+      _setDir(handle, STEPPER_DIR_REVERSE);
+    }
+  }
+
+  return err;
+}
+
 uint8_t stepper_getPos( stepper_descriptor_t handle) {
   return steppers[handle].pos;
 }
@@ -262,12 +406,7 @@ stepper_err_t stepper_setDir(stepper_descriptor_t handle, stepper_dir_t dir) {
   ) {
     err = STEPPER_ERR_HANDLE_INVALID;
   } else {
-    steppers[handle].dir = dir;
-    if (dir == STEPPER_DIR_FORWARD) {
-      *steppers[handle].dir_port &= ~(dir << steppers[handle].dir_pin);
-    } else {
-      *steppers[handle].dir_port |= (dir << steppers[handle].dir_pin);
-    }
+    _setDir(handle, dir);
   }
   return err;
 }
@@ -279,32 +418,13 @@ stepper_dir_t stepper_getDir(stepper_descriptor_t handle) {
 
 stepper_err_t stepper_stepEngage(stepper_descriptor_t handle) {
   stepper_err_t err = STEPPER_ERR_NONE;
+
   if (handle >= MAX_STEPPERS
     || steppers[handle].status == STEPPER_STATUS_AVAILABLE
   ) {
     err = STEPPER_ERR_HANDLE_INVALID;
-  } else {
-    // its not an error, but don't set the step bit if the stepper is disabled
-    // or if there is no need for stepping
-    if (steppers[handle].status == STEPPER_STATUS_ENABLED
-      && ((steppers[handle].pos != steppers[handle].desired_pos_1)
-      || steppers[handle].mode == STEPPER_MODE_CONTINUOUS)
-    ) {
-      *steppers[handle].step_port |= (1 << steppers[handle].step_pin);
-      if (steppers[handle].dir == STEPPER_DIR_FORWARD) {
-        if (steppers[handle].pos == 199) {
-          steppers[handle].pos = 0;
-        } else {
-          steppers[handle].pos++;
-        }
-      } else if (steppers[handle].dir == STEPPER_DIR_REVERSE) {
-        if (steppers[handle].pos == 0) {
-          steppers[handle].pos = 199;
-        } else {
-          steppers[handle].pos--;
-        }
-      }
-    }
+  } else if (_engage(handle)) {
+    *steppers[handle].step_port |= (1 << steppers[handle].step_pin);
   }
 
   return err;
@@ -312,7 +432,6 @@ stepper_err_t stepper_stepEngage(stepper_descriptor_t handle) {
 
 stepper_err_t stepper_stepRelease(stepper_descriptor_t handle) {
   stepper_err_t err = STEPPER_ERR_NONE;
-  uint8_t temp;
 
   if (handle >= MAX_STEPPERS
     || steppers[handle].status == STEPPER_STATUS_AVAILABLE
@@ -320,18 +439,52 @@ stepper_err_t stepper_stepRelease(stepper_descriptor_t handle) {
     err = STEPPER_ERR_HANDLE_INVALID;
   } else {
     *steppers[handle].step_port &= ~(1 << steppers[handle].step_pin);
-    if (steppers[handle].desired_pos_1 == steppers[handle].pos
-      && steppers[handle].mode == STEPPER_MODE_OSCILLATE
-    ) {
-      temp = steppers[handle].desired_pos_1;
-      steppers[handle].desired_pos_1 = steppers[handle].desired_pos_2;
-      steppers[handle].desired_pos_2 = temp;
-      if (steppers[handle].dir == STEPPER_DIR_REVERSE) {
-        steppers[handle].dir = STEPPER_DIR_FORWARD;
-      } else if (steppers[handle].dir == STEPPER_DIR_FORWARD) {
-        steppers[handle].dir = STEPPER_DIR_REVERSE;
+    steppers[handle].step_high = 0;
+    _release(handle);
+  }
+
+  return err;
+}
+
+// does the work of stepper_stepEngage() and stepper_stepRelease() for every
+// handle in one call per tick. a step line raised on one call is lowered on
+// the next, before the release for that step happens, so every pulse is a
+// tick wide, dir never changes under a raised line and a stepper steps at
+// most every other call. the lines raised are written together, once per
+// step port
+stepper_err_t stepper_step(
+  const stepper_descriptor_t *handles,
+  uint8_t num_handles
+) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+  stepper_t *stepper;
+  uint8_t *ports[MAX_STEPPERS];
+  uint8_t pins[MAX_STEPPERS];
+  uint8_t high_mask = 0;
+  uint8_t num_pins = 0;
+  uint8_t i;
+
+  if (!_isBatchValid(handles, num_handles)) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else {
+    for (i=0;i<num_handles;i++) {
+      stepper = &steppers[handles[i]];
+      if (stepper->step_high) {
+        *stepper->step_port &= ~(1 << stepper->step_pin);
+        stepper->step_high = 0;
+        _release(handles[i]);
+      } else if (_engage(handles[i])) {
+        stepper->step_high = 1;
+        ports[num_pins] = stepper->step_port;
+        pins[num_pins] = stepper->step_pin;
+        high_mask |= (1 << num_pins);
+        num_pins++;
+      } else {
+        // nothing was raised, so the release is due straight away
+        _release(handles[i]);
       }
     }
+    _writeBatch(ports, pins, num_pins, high_mask);
   }
 
   return err;
@@ -351,6 +504,7 @@ stepper_err_t stepper_setMode(stepper_descriptor_t handle, stepper_mode_t mode)
     err = STEPPER_ERR_OPTION_INVALID;
   } else {
     steppers[handle].mode = mode;
+    steppers[handle].hold = 0;
   }
 
   return err;
@@ -358,3 +512,632 @@ stepper_err_t stepper_setMode(stepper_descriptor_t handle, stepper_mode_t mode)
 stepper_mode_t stepper_getMode(stepper_descriptor_t handle) {
   return steppers[handle].mode;
 }
+
+// number of steps left to reach desired_pos_1 travelling in the current
+// direction, used to size motion profiles
+uint8_t stepper_getStepsRemaining(stepper_descriptor_t handle) {
+  uint8_t steps;
+
+  if (steppers[handle].dir == STEPPER_DIR_REVERSE) {
+    steps = (MAX_STEPPER_POS + 1 + steppers[handle].pos
+      - steppers[handle].desired_pos_1) % (MAX_STEPPER_POS + 1);
+  } else {
+    steps = (MAX_STEPPER_POS + 1 + steppers[handle].desired_pos_1
+      - steppers[handle].pos) % (MAX_STEPPER_POS + 1);
+  }
+
+  return steps;
+}
+
+stepper_err_t stepper_setBacklash(stepper_descriptor_t handle, uint8_t steps) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+
+  if (handle >= MAX_STEPPERS
+    || steppers[handle].status == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else {
+    steppers[handle].backlash = steps;
+    steppers[handle].backlash_pending = 0;
+  }
+
+  return err;
+}
+
+uint8_t stepper_getBacklash(stepper_descriptor_t handle) {
+  return steppers[handle].backlash;
+}
+
+// compensation steps still to be issued after the last reversal, the caller
+// can run its step timer at full rate while this is non-zero
+uint8_t stepper_getBacklashPending(stepper_descriptor_t handle) {
+  return steppers[handle].backlash_pending;
+}
+
+// replaces the outstanding correction with steps extra steps in the current
+// direction, issued ahead of normal motion without changing pos
+stepper_err_t stepper_setCorrection(
+  stepper_descriptor_t handle,
+  uint8_t steps
+) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+
+  if (handle >= MAX_STEPPERS
+    || steppers[handle].status == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else {
+    steppers[handle].correction_pending = steps;
+  }
+
+  return err;
+}
+
+uint8_t stepper_getCorrectionPending(stepper_descriptor_t handle) {
+  return steppers[handle].correction_pending;
+}
+
+// in OSCILLATE mode, slows down over the last ramp_steps steps before each
+// end and speeds back up over the first ramp_steps after it, waiting
+// dwell_ticks at the end in between. with both 0 it reverses on the spot
+stepper_err_t stepper_setTurnaround(
+  stepper_descriptor_t handle,
+  uint8_t ramp_steps,
+  uint8_t dwell_ticks
+) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+
+  if (handle >= MAX_STEPPERS
+    || steppers[handle].status == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else {
+    steppers[handle].ramp_steps = ramp_steps;
+    steppers[handle].dwell_ticks = dwell_ticks;
+  }
+
+  return err;
+}
+
+// in OSCILLATE mode, runs one cycle between each pair of end points in turn
+// and then starts over. pairs must stay valid while in use, 0 pairs goes
+// back to oscillating between the desired positions
+stepper_err_t stepper_setSequence(
+  stepper_descriptor_t handle,
+  const stepper_pair_t *pairs,
+  uint8_t num_pairs
+) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+  uint8_t i;
+
+  if (handle >= MAX_STEPPERS
+    || steppers[handle].status == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else {
+    for (i=0;i<num_pairs;i++) {
+      if (pairs[i].pos_1 > MAX_STEPPER_POS
+        || pairs[i].pos_2 > MAX_STEPPER_POS
+      ) {
+        err = STEPPER_ERR_POSITION_INVALID;
+      }
+    }
+  }
+
+  if (err == STEPPER_ERR_NONE) {
+    steppers[handle].sequence = pairs;
+    steppers[handle].sequence_len = num_pairs;
+    steppers[handle].sequence_index = 0;
+    steppers[handle].leg = 0;
+    if (num_pairs > 0) {
+      // finish the last pair's cycle so the turnaround loads the first
+      steppers[handle].sequence_index = num_pairs - 1;
+      steppers[handle].leg = 1;
+      _turnAround(handle);
+    }
+  }
+
+  return err;
+}
+
+uint8_t stepper_getSequenceIndex(stepper_descriptor_t handle) {
+  return steppers[handle].sequence_index;
+}
+
+// enables handles[i] if bit i of enable_mask is set and disables it if not,
+// writing each enable port once so steppers sharing a port switch together
+stepper_err_t stepper_setEnables(
+  const stepper_descriptor_t *handles,
+  uint8_t num_handles,
+  uint8_t enable_mask
+) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+  uint8_t *ports[MAX_STEPPERS];
+  uint8_t pins[MAX_STEPPERS];
+  uint8_t i;
+
+  if (!_isBatchValid(handles, num_handles)) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else {
+    for (i=0;i<num_handles;i++) {
+      ports[i] = steppers[handles[i]].enable_port;
+      pins[i] = steppers[handles[i]].enable_pin;
+      if (enable_mask & (1 << i)) {
+        if (steppers[handles[i]].status != STEPPER_STATUS_ENABLED) {
+          steppers[handles[i]].waking = steppers[handles[i]].wake_ticks;
+        }
+        steppers[handles[i]].status = STEPPER_STATUS_ENABLED;
+        _wake(handles[i]);
+      } else {
+        steppers[handles[i]].status = STEPPER_STATUS_DISABLED;
+        _clearIdle(handles[i]);
+      }
+    }
+    // this pin is active low
+    _writeBatch(ports, pins, num_handles, ~enable_mask);
+  }
+
+  return err;
+}
+
+// reverses handles[i] if bit i of reverse_mask is set and runs it forward if
+// not, writing each dir port once
+stepper_err_t stepper_setDirs(
+  const stepper_descriptor_t *handles,
+  uint8_t num_handles,
+  uint8_t reverse_mask
+) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+  stepper_t *stepper;
+  uint8_t *ports[MAX_STEPPERS];
+  uint8_t pins[MAX_STEPPERS];
+  uint8_t high_mask = 0;
+  uint8_t num_pins = 0;
+  uint8_t i;
+
+  if (!_isBatchValid(handles, num_handles)) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else {
+    for (i=0;i<num_handles;i++) {
+      stepper = &steppers[handles[i]];
+      _setDirState(
+        handles[i],
+        (reverse_mask & (1 << i)) ? STEPPER_DIR_REVERSE : STEPPER_DIR_FORWARD
+      );
+      // steppers with dir timing are left for their own tick to write
+      if (stepper->dir_setup > 0 || stepper->dir_hold > 0) {
+        stepper->dir_pending = (_readDir(handles[i]) != stepper->dir);
+      } else {
+        ports[num_pins] = stepper->dir_port;
+        pins[num_pins] = stepper->dir_pin;
+        if (stepper->dir == STEPPER_DIR_REVERSE) {
+          high_mask |= (1 << num_pins);
+        }
+        num_pins++;
+      }
+    }
+    _writeBatch(ports, pins, num_pins, high_mask);
+  }
+
+  return err;
+}
+
+// where the driver's current is set, either a port with mask picking out the
+// pin that selects reduced current or a pwm compare register with mask 0xff.
+// run_value is written straight away, a pin must already be an output
+stepper_err_t stepper_setCurrentControl(
+  stepper_descriptor_t handle,
+  uint8_t *reg,
+  uint8_t mask,
+  uint8_t run_value,
+  uint8_t reduced_value
+) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+
+  if (handle >= MAX_STEPPERS
+    || steppers[handle].status == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else if (reg == 0) {
+    err = STEPPER_ERR_OPTION_INVALID;
+  } else {
+    steppers[handle].current_reg = reg;
+    steppers[handle].current_mask = mask;
+    steppers[handle].current_run = run_value;
+    steppers[handle].current_reduced = reduced_value;
+    _wake(handle);
+    _writeCurrent(handle, run_value);
+  }
+
+  return err;
+}
+
+// once an enabled stepper has had nothing to step for idle_ticks ticks its
+// driver is dropped to reduced current or switched off. it comes back by
+// itself when there is a step to make, wake_ticks ticks before making it.
+// the status stays enabled throughout
+stepper_err_t stepper_setIdle(
+  stepper_descriptor_t handle,
+  stepper_idle_t action,
+  uint16_t idle_ticks,
+  uint8_t wake_ticks
+) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+
+  if (handle >= MAX_STEPPERS
+    || steppers[handle].status == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else if ((action != STEPPER_IDLE_NONE
+      && action != STEPPER_IDLE_REDUCE
+      && action != STEPPER_IDLE_DISABLE)
+    || (action == STEPPER_IDLE_REDUCE && steppers[handle].current_reg == 0)
+  ) {
+    err = STEPPER_ERR_OPTION_INVALID;
+  } else {
+    _wake(handle);
+    steppers[handle].idle_action = action;
+    steppers[handle].idle_ticks = idle_ticks;
+    steppers[handle].wake_ticks = wake_ticks;
+  }
+
+  return err;
+}
+
+stepper_idle_t stepper_getIdle(stepper_descriptor_t handle) {
+  return steppers[handle].idle;
+}
+
+// makes a change of direction wait hold_ticks ticks after the last step
+// before the dir pin is written, then setup_ticks ticks more before the
+// next step, counted by stepper_stepEngage(). with both 0 the pin is written
+// as soon as the direction is set
+stepper_err_t stepper_setDirTiming(
+  stepper_descriptor_t handle,
+  uint8_t setup_ticks,
+  uint8_t hold_ticks
+) {
+  stepper_err_t err = STEPPER_ERR_NONE;
+  stepper_t *stepper;
+
+  if (handle >= MAX_STEPPERS
+    || steppers[handle].status == STEPPER_STATUS_AVAILABLE
+  ) {
+    err = STEPPER_ERR_HANDLE_INVALID;
+  } else {
+    stepper = &steppers[handle];
+    stepper->dir_setup = setup_ticks;
+    stepper->dir_hold = hold_ticks;
+    if (stepper->dir_setup_left > setup_ticks) {
+      stepper->dir_setup_left = setup_ticks;
+    }
+    if (stepper->dir_hold_left > hold_ticks) {
+      stepper->dir_hold_left = hold_ticks;
+    }
+    if (setup_ticks == 0 && hold_ticks == 0 && stepper->dir_pending) {
+      _writeDir(handle);
+      stepper->dir_pending = 0;
+    }
+  }
+
+  return err;
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static void _setDir(stepper_descriptor_t handle, stepper_dir_t dir) {
+  _setDirState(handle, dir);
+  if (steppers[handle].dir_setup > 0 || steppers[handle].dir_hold > 0) {
+    // nothing to write if the pin already points the new way, e.g. after
+    // reversing twice before the tick came round
+    steppers[handle].dir_pending = (_readDir(handle) != dir);
+  } else {
+    _writeDir(handle);
+  }
+}
+
+static void _writeDir(stepper_descriptor_t handle) {
+  if (steppers[handle].dir == STEPPER_DIR_FORWARD) {
+    *steppers[handle].dir_port &= ~(1 << steppers[handle].dir_pin);
+  } else {
+    *steppers[handle].dir_port |= (1 << steppers[handle].dir_pin);
+  }
+}
+
+static stepper_dir_t _readDir(stepper_descriptor_t handle) {
+  return (*steppers[handle].dir_port & (1 << steppers[handle].dir_pin))
+    ? STEPPER_DIR_REVERSE
+    : STEPPER_DIR_FORWARD;
+}
+
+// counts down the dir pin timing and writes a pending direction once the
+// last step has been held for long enough. runs every tick, so the setup
+// time overlaps any dwell, ramp or wake up time
+static void _dirTick(stepper_descriptor_t handle) {
+  stepper_t *stepper = &steppers[handle];
+
+  if (stepper->dir_setup_left > 0) {
+    stepper->dir_setup_left--;
+  }
+  if (stepper->dir_hold_left > 0) {
+    stepper->dir_hold_left--;
+  }
+  if (stepper->dir_pending && stepper->dir_hold_left == 0) {
+    _writeDir(handle);
+    stepper->dir_pending = 0;
+    stepper->dir_setup_left = stepper->dir_setup;
+  }
+}
+
+static void _setDirState(stepper_descriptor_t handle, stepper_dir_t dir) {
+  // on a reversal whatever slack was already taken up going the old way is
+  // the slack still to cross going the new way
+  if (dir != steppers[handle].dir) {
+    steppers[handle].backlash_pending = steppers[handle].backlash
+      - steppers[handle].backlash_pending;
+  }
+
+  steppers[handle].dir = dir;
+}
+
+static uint8_t _isBatchValid(
+  const stepper_descriptor_t *handles,
+  uint8_t num_handles
+) {
+  uint8_t valid = (num_handles <= MAX_STEPPERS);
+  uint8_t i;
+  uint8_t j;
+
+  for (i=0;i<num_handles && valid;i++) {
+    valid = (handles[i] < MAX_STEPPERS
+      && steppers[handles[i]].status != STEPPER_STATUS_AVAILABLE);
+    // a handle listed twice would be stepped or written twice
+    for (j=0;j<i && valid;j++) {
+      valid = (handles[j] != handles[i]);
+    }
+  }
+
+  return valid;
+}
+
+// sets pins[i] on ports[i] high if bit i of high_mask is set and low if not,
+// with a single read-modify-write of each distinct port
+static void _writeBatch(
+  uint8_t *const *ports,
+  const uint8_t *pins,
+  uint8_t num_pins,
+  uint8_t high_mask
+) {
+  uint8_t set;
+  uint8_t clear;
+  uint8_t i;
+  uint8_t j;
+
+  for (i=0;i<num_pins;i++) {
+    // the first pin on a port writes it for all the others
+    j = 0;
+    while (j < i && ports[j] != ports[i]) {
+      j++;
+    }
+    if (j == i) {
+      set = 0;
+      clear = 0;
+      for (j=i;j<num_pins;j++) {
+        if (ports[j] == ports[i]) {
+          if (high_mask & (1 << j)) {
+            set |= (1 << pins[j]);
+          } else {
+            clear |= (1 << pins[j]);
+          }
+        }
+      }
+      *ports[i] = (*ports[i] & ~clear) | set;
+    }
+  }
+}
+
+// swaps the end points and reverses, or at the end of a cycle moves on to
+// the next pair in the sequence
+static void _turnAround(stepper_descriptor_t handle) {
+  stepper_t *stepper = &steppers[handle];
+  uint8_t temp;
+
+  stepper->leg ^= 1;
+  if (stepper->leg == 0 && stepper->sequence_len > 0) {
+    stepper->sequence_index++;
+    if (stepper->sequence_index >= stepper->sequence_len) {
+      stepper->sequence_index = 0;
+    }
+    stepper->desired_pos_1 = stepper->sequence[stepper->sequence_index].pos_1;
+    stepper->desired_pos_2 = stepper->sequence[stepper->sequence_index].pos_2;
+  } else {
+    temp = stepper->desired_pos_1;
+    stepper->desired_pos_1 = stepper->desired_pos_2;
+    stepper->desired_pos_2 = temp;
+  }
+
+  // a pair need not start where the last one ended, so sequences head
+  // straight for the next end rather than just reversing
+  if (stepper->sequence_len > 0) {
+    if (stepper->desired_pos_1 > stepper->pos) {
+      _setDir(handle, STEPPER_DIR_FORWARD);
+    } else {
+      _setDir(handle, STEPPER_DIR_REVERSE);
+    }
+  } else {
+    if (stepper->dir == STEPPER_DIR_REVERSE) {
+      _setDir(handle, STEPPER_DIR_FORWARD);
+    } else if (stepper->dir == STEPPER_DIR_FORWARD) {
+      _setDir(handle, STEPPER_DIR_REVERSE);
+    }
+  }
+
+  stepper->travelled = 0;
+  stepper->hold = stepper->dwell_ticks + _getRampHold(handle);
+}
+
+// ticks to wait before the next step so that speed falls off as the square
+// root of the distance to the nearer end, as it would under constant
+// deceleration. the step n ticks apart satisfies n * n * distance >= ramp
+static uint8_t _getRampHold(stepper_descriptor_t handle) {
+  uint8_t distance = stepper_getStepsRemaining(handle);
+  uint8_t interval = 1;
+
+  if (steppers[handle].travelled < distance) {
+    distance = steppers[handle].travelled;
+  }
+  if (distance == 0) {
+    distance = 1;
+  }
+
+  while ((uint16_t)interval * interval * distance
+    < steppers[handle].ramp_steps
+  ) {
+    interval++;
+  }
+
+  return interval - 1;
+}
+
+// one tick's worth of stepping, returns whether the step line should go
+// high. its not an error, but nothing is stepped if the stepper is disabled
+// or there is no need for stepping
+static uint8_t _engage(stepper_descriptor_t handle) {
+  uint8_t stepped = 0;
+
+  _dirTick(handle);
+
+  if (steppers[handle].hold > 0) {
+    steppers[handle].hold--;
+  } else if (steppers[handle].status != STEPPER_STATUS_ENABLED) {
+    // nothing to do
+  } else if (steppers[handle].pos == steppers[handle].desired_pos_1
+    && steppers[handle].mode != STEPPER_MODE_CONTINUOUS
+    && steppers[handle].correction_pending == 0
+  ) {
+    _idleTick(handle);
+  } else {
+    // a driver put to sleep while idle is woken up and given its wake up
+    // time before the step that needs it
+    _wake(handle);
+    if (steppers[handle].waking > 0) {
+      steppers[handle].waking--;
+    } else if (steppers[handle].dir_pending
+      || steppers[handle].dir_setup_left > 0
+    ) {
+      // the dir pin hasn't settled yet
+    } else {
+      _step(handle);
+      stepped = 1;
+    }
+  }
+
+  return stepped;
+}
+
+// the oscillate turnaround, once the step to the end has been released
+static void _release(stepper_descriptor_t handle) {
+  if (steppers[handle].desired_pos_1 == steppers[handle].pos
+    && steppers[handle].mode == STEPPER_MODE_OSCILLATE
+    && steppers[handle].hold == 0
+  ) {
+    _turnAround(handle);
+  }
+}
+
+// moves the position on by one step
+static void _step(stepper_descriptor_t handle) {
+  uint8_t last_pos = steppers[handle].pos;
+
+  steppers[handle].dir_hold_left = steppers[handle].dir_hold;
+  // take up the slack left by a reversal, then replace any steps the
+  // motor is known to have lost, before the position moves
+  if (steppers[handle].backlash_pending > 0) {
+    steppers[handle].backlash_pending--;
+  } else if (steppers[handle].correction_pending > 0) {
+    steppers[handle].correction_pending--;
+  } else if (steppers[handle].dir == STEPPER_DIR_FORWARD) {
+    if (steppers[handle].pos == 199) {
+      steppers[handle].pos = 0;
+    } else {
+      steppers[handle].pos++;
+    }
+  } else if (steppers[handle].dir == STEPPER_DIR_REVERSE) {
+    if (steppers[handle].pos == 0) {
+      steppers[handle].pos = 199;
+    } else {
+      steppers[handle].pos--;
+    }
+  }
+
+  // ease into and out of the oscillate ends, the turnaround itself
+  // happens in stepper_stepRelease()
+  if (steppers[handle].mode == STEPPER_MODE_OSCILLATE
+    && steppers[handle].pos != steppers[handle].desired_pos_1
+  ) {
+    if (steppers[handle].pos != last_pos
+      && steppers[handle].travelled < 255
+    ) {
+      steppers[handle].travelled++;
+    }
+    steppers[handle].hold = _getRampHold(handle);
+  }
+}
+
+// counts a tick with nothing to step and puts the driver to sleep once
+// there have been enough of them
+static void _idleTick(stepper_descriptor_t handle) {
+  stepper_t *stepper = &steppers[handle];
+
+  if (stepper->waking > 0) {
+    stepper->waking--;
+  }
+
+  if (stepper->idle == STEPPER_IDLE_NONE
+    && stepper->idle_action != STEPPER_IDLE_NONE
+  ) {
+    if (stepper->idle_count < stepper->idle_ticks) {
+      stepper->idle_count++;
+    } else if (stepper->idle_action == STEPPER_IDLE_REDUCE) {
+      _writeCurrent(handle, stepper->current_reduced);
+      stepper->idle = STEPPER_IDLE_REDUCE;
+    } else {
+      // this pin is active low
+      *stepper->enable_port |= (1 << stepper->enable_pin);
+      stepper->idle = STEPPER_IDLE_DISABLE;
+    }
+  }
+}
+
+// undoes whatever was done to an idle driver and starts its wake up time
+static void _wake(stepper_descriptor_t handle) {
+  stepper_t *stepper = &steppers[handle];
+
+  if (stepper->idle == STEPPER_IDLE_DISABLE) {
+    *stepper->enable_port &= ~(1 << stepper->enable_pin);
+  }
+  if (stepper->idle != STEPPER_IDLE_NONE) {
+    stepper->waking = stepper->wake_ticks;
+  }
+  _clearIdle(handle);
+}
+
+// forgets the idle state without switching the driver on, for when it is
+// being disabled. stepper_enable() gives it its wake up time again
+static void _clearIdle(stepper_descriptor_t handle) {
+  stepper_t *stepper = &steppers[handle];
+
+  if (stepper->idle == STEPPER_IDLE_REDUCE) {
+    _writeCurrent(handle, stepper->current_run);
+  }
+  stepper->idle = STEPPER_IDLE_NONE;
+  stepper->idle_count = 0;
+}
+
+static void _writeCurrent(stepper_descriptor_t handle, uint8_t value) {
+  stepper_t *stepper = &steppers[handle];
+
+  *stepper->current_reg = (*stepper->current_reg & ~stepper->current_mask)
+    | (value & stepper->current_mask);
+}
@@ -39,6 +39,14 @@ typedef enum stepper_mode_t {
   STEPPER_MODE_CONTINUOUS
 } stepper_mode_t;
 
+// what an enabled stepper does to its driver once it has been idle long
+// enough, and what it is currently doing
+typedef enum stepper_idle_t {
+  STEPPER_IDLE_NONE,
+  STEPPER_IDLE_REDUCE,
+  STEPPER_IDLE_DISABLE
+} stepper_idle_t;
+
 typedef struct stepper_attr_t {
   uint8_t *dir_port;
   uint8_t *dir_port_ddr;
@@ -70,6 +78,12 @@ typedef struct stepper_attr_t {
 
 typedef uint8_t stepper_descriptor_t;
 
+// one oscillate cycle, out to pos_1 and back to pos_2
+typedef struct stepper_pair_t {
+  uint8_t pos_1;
+  uint8_t pos_2;
+} stepper_pair_t;
+
 /*******************************************************************************
 * Public Function Declarations
 *******************************************************************************/
@@ -93,6 +107,8 @@ stepper_err_t stepper_setPos(
   uint8_t pos_1,
   uint8_t pos_2
 );
+stepper_err_t stepper_seedPos(stepper_descriptor_t handle, uint8_t pos);
+stepper_err_t stepper_move(stepper_descriptor_t handle, int16_t steps);
 uint8_t stepper_getPos( stepper_descriptor_t handle);
 uint8_t stepper_getDesiredPos1(stepper_descriptor_t handle);
 uint8_t stepper_getDesiredPos2(stepper_descriptor_t handle);
@@ -100,7 +116,57 @@ stepper_err_t stepper_setDir(stepper_descriptor_t handle, stepper_dir_t dir);
 stepper_dir_t stepper_getDir(stepper_descriptor_t handle);
 stepper_err_t stepper_stepEngage(stepper_descriptor_t handle);
 stepper_err_t stepper_stepRelease(stepper_descriptor_t handle);
+stepper_err_t stepper_step(
+  const stepper_descriptor_t *handles,
+  uint8_t num_handles
+);
 stepper_err_t stepper_setMode(stepper_descriptor_t handle, stepper_mode_t mode);
 stepper_mode_t stepper_getMode(stepper_descriptor_t handle);
+uint8_t stepper_getStepsRemaining(stepper_descriptor_t handle);
+stepper_err_t stepper_setBacklash(stepper_descriptor_t handle, uint8_t steps);
+uint8_t stepper_getBacklash(stepper_descriptor_t handle);
+uint8_t stepper_getBacklashPending(stepper_descriptor_t handle);
+stepper_err_t stepper_setCorrection(stepper_descriptor_t handle, uint8_t steps);
+uint8_t stepper_getCorrectionPending(stepper_descriptor_t handle);
+stepper_err_t stepper_setTurnaround(
+  stepper_descriptor_t handle,
+  uint8_t ramp_steps,
+  uint8_t dwell_ticks
+);
+stepper_err_t stepper_setSequence(
+  stepper_descriptor_t handle,
+  const stepper_pair_t *pairs,
+  uint8_t num_pairs
+);
+uint8_t stepper_getSequenceIndex(stepper_descriptor_t handle);
+stepper_err_t stepper_setEnables(
+  const stepper_descriptor_t *handles,
+  uint8_t num_handles,
+  uint8_t enable_mask
+);
+stepper_err_t stepper_setDirs(
+  const stepper_descriptor_t *handles,
+  uint8_t num_handles,
+  uint8_t reverse_mask
+);
+stepper_err_t stepper_setCurrentControl(
+  stepper_descriptor_t handle,
+  uint8_t *reg,
+  uint8_t mask,
+  uint8_t run_value,
+  uint8_t reduced_value
+);
+stepper_err_t stepper_setIdle(
+  stepper_descriptor_t handle,
+  stepper_idle_t action,
+  uint16_t idle_ticks,
+  uint8_t wake_ticks
+);
+stepper_idle_t stepper_getIdle(stepper_descriptor_t handle);
+stepper_err_t stepper_setDirTiming(
+  stepper_descriptor_t handle,
+  uint8_t setup_ticks,
+  uint8_t hold_ticks
+);
 
 #endif // _STEPPER_H
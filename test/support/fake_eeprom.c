@@ -0,0 +1,53 @@
+#include "fake_eeprom.h"
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static uint8_t cells[FAKE_EEPROM_SIZE];
+static uint16_t writes[FAKE_EEPROM_SIZE];
+static uint16_t writes_left;
+static uint16_t stuck_addr;
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// erased eeprom reads back 0xFF
+void fake_eeprom_init(void) {
+  uint16_t i;
+
+  for (i=0;i<FAKE_EEPROM_SIZE;i++) {
+    cells[i] = 0xFF;
+    writes[i] = 0;
+  }
+  writes_left = FAKE_EEPROM_NO_FAULT;
+  stuck_addr = FAKE_EEPROM_NO_FAULT;
+}
+
+uint8_t fake_eeprom_read(uint16_t addr) {
+  return cells[addr % FAKE_EEPROM_SIZE];
+}
+
+void fake_eeprom_write(uint16_t addr, uint8_t value) {
+  addr %= FAKE_EEPROM_SIZE;
+  if (writes_left != 0 && addr != stuck_addr) {
+    if (writes_left != FAKE_EEPROM_NO_FAULT) {
+      writes_left--;
+    }
+    cells[addr] = value;
+    writes[addr]++;
+  }
+}
+
+// drops every write after the next few, like power failing mid-save
+void fake_eeprom_failAfter(uint16_t count) {
+  writes_left = count;
+}
+
+// a worn out cell that ignores writes
+void fake_eeprom_stuck(uint16_t addr) {
+  stuck_addr = addr;
+}
+
+uint16_t fake_eeprom_getWrites(uint16_t addr) {
+  return writes[addr % FAKE_EEPROM_SIZE];
+}
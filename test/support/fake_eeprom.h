@@ -0,0 +1,21 @@
+#ifndef _FAKE_EEPROM_H
+#define _FAKE_EEPROM_H
+
+#include <stdint.h>
+/*******************************************************************************
+* Public Defines
+*******************************************************************************/
+#define FAKE_EEPROM_SIZE 1024
+#define FAKE_EEPROM_NO_FAULT 0xFFFF
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+void fake_eeprom_init(void);
+uint8_t fake_eeprom_read(uint16_t addr);
+void fake_eeprom_write(uint16_t addr, uint8_t value);
+void fake_eeprom_failAfter(uint16_t count);
+void fake_eeprom_stuck(uint16_t addr);
+uint16_t fake_eeprom_getWrites(uint16_t addr);
+
+#endif // _FAKE_EEPROM_H
@@ -0,0 +1,50 @@
+#include "fake_encoder.h"
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+// quadrature states in forward order, each is (a << 1) | b
+static const uint8_t sequence[4] = {0, 1, 3, 2};
+
+static uint8_t *port;
+static uint8_t a;
+static uint8_t b;
+static uint8_t seq_index;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _write(void);
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+void fake_encoder_init(uint8_t *pin_reg, uint8_t a_pin, uint8_t b_pin) {
+  port = pin_reg;
+  a = a_pin;
+  b = b_pin;
+  seq_index = 0;
+  _write();
+}
+
+// moves the a and b lines by one quadrature count, +1 forward and -1 reverse
+void fake_encoder_count(int8_t dir) {
+  seq_index = (uint8_t)(seq_index + dir) & 3;
+  _write();
+}
+
+// skips a state so both lines change together, like a missed edge
+void fake_encoder_glitch(void) {
+  seq_index = (seq_index + 2) & 3;
+  _write();
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static void _write(void) {
+  uint8_t state = sequence[seq_index];
+
+  *port &= ~((1 << a) | (1 << b));
+  *port |= (((state >> 1) & 1) << a) | ((state & 1) << b);
+}
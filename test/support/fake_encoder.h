@@ -0,0 +1,12 @@
+#ifndef _FAKE_ENCODER_H
+#define _FAKE_ENCODER_H
+
+#include <stdint.h>
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+void fake_encoder_init(uint8_t *pin_reg, uint8_t a_pin, uint8_t b_pin);
+void fake_encoder_count(int8_t dir);
+void fake_encoder_glitch(void);
+
+#endif // _FAKE_ENCODER_H
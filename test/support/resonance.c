@@ -0,0 +1,39 @@
+#include "resonance.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define RESONANCE_PI 3.14159265358979
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+void resonance_init(
+  resonance_t *model,
+  uint16_t freq_dhz,
+  uint16_t damping_pm,
+  uint32_t tick_hz
+) {
+  model->omega = 2 * RESONANCE_PI * freq_dhz / 10.0;
+  model->zeta = damping_pm / 1000.0;
+  model->dt = 1.0 / tick_hz;
+  model->base = 0;
+  model->load = 0;
+  model->load_vel = 0;
+}
+
+// moves the motor by step and advances the load by one tick
+void resonance_tick(resonance_t *model, int8_t step) {
+  double accel;
+
+  model->base += step;
+  accel = model->omega * model->omega * (model->base - model->load)
+    - 2 * model->zeta * model->omega * model->load_vel;
+  model->load_vel += accel * model->dt;
+  model->load += model->load_vel * model->dt;
+}
+
+// how far the load trails the motor, in steps
+double resonance_getError(resonance_t *model) {
+  return model->load - model->base;
+}
@@ -0,0 +1,31 @@
+#ifndef _RESONANCE_H
+#define _RESONANCE_H
+
+#include <stdint.h>
+/*******************************************************************************
+* Public Typedefs
+*******************************************************************************/
+// a load hanging off the motor by a damped spring, e.g. a carriage on a belt,
+// positions are in steps
+typedef struct resonance_t {
+  double omega;
+  double zeta;
+  double dt;
+  double base;
+  double load;
+  double load_vel;
+} resonance_t;
+
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+void resonance_init(
+  resonance_t *model,
+  uint16_t freq_dhz,
+  uint16_t damping_pm,
+  uint32_t tick_hz
+);
+void resonance_tick(resonance_t *model, int8_t step);
+double resonance_getError(resonance_t *model);
+
+#endif // _RESONANCE_H
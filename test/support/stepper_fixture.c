@@ -0,0 +1,52 @@
+#include "stepper_fixture.h"
+
+/*******************************************************************************
+* Private Data
+*******************************************************************************/
+static uint8_t fixture_port;
+static uint8_t fixture_port_ddr;
+
+/*******************************************************************************
+* Public Function Definitions
+*******************************************************************************/
+// every line of the driver on one port, dir on pin 0 then enable, step, ms1,
+// ms2 and ms3
+stepper_attr_t stepper_fixture_attr(uint8_t *port, uint8_t *port_ddr) {
+  stepper_attr_t config;
+  config.dir_port = port;
+  config.dir_port_ddr = port_ddr;
+  config.dir_pin = 0;
+
+  config.enable_port = port;
+  config.enable_port_ddr = port_ddr;
+  config.enable_pin = 1;
+
+  config.step_port = port;
+  config.step_port_ddr = port_ddr;
+  config.step_pin = 2;
+
+  config.ms1_port = port;
+  config.ms1_port_ddr = port_ddr;
+  config.ms1_pin = 3;
+
+  config.ms2_port = port;
+  config.ms2_port_ddr = port_ddr;
+  config.ms2_pin = 4;
+
+  config.ms3_port = port;
+  config.ms3_port_ddr = port_ddr;
+  config.ms3_pin = 5;
+
+  config.speed = 0;
+
+  return config;
+}
+
+// a stepper for tests that only care about its position, every stepper made
+// here shares the one fake port
+stepper_err_t stepper_fixture_make(stepper_descriptor_t *handle) {
+  return stepper_construct(
+    stepper_fixture_attr(&fixture_port, &fixture_port_ddr),
+    handle
+  );
+}
@@ -0,0 +1,12 @@
+#ifndef _STEPPER_FIXTURE_H
+#define _STEPPER_FIXTURE_H
+
+#include <stdint.h>
+#include "stepper.h"
+/*******************************************************************************
+* Public Function Declarations
+*******************************************************************************/
+stepper_attr_t stepper_fixture_attr(uint8_t *port, uint8_t *port_ddr);
+stepper_err_t stepper_fixture_make(stepper_descriptor_t *handle);
+
+#endif // _STEPPER_FIXTURE_H
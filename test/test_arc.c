@@ -0,0 +1,227 @@
+#include "unity.h"
+#include "stepper_fixture.h"
+#include <math.h>
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "arc.h"
+#include "stepper.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPERS 2
+#define MAX_STEPPER_POS 199
+// a chebyshev path round a circle never needs more than this
+#define MAX_ARC_STEPS(r) (8 * (r) + 8)
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static stepper_descriptor_t stepper_handles[MAX_STEPPERS];
+static arc_t arc;
+static arc_attr_t config;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static double _run(uint16_t *steps);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  config.start_x = 50;
+  config.start_y = 0;
+  config.end_x = 0;
+  config.end_y = 50;
+  config.dir = ARC_DIR_CCW;
+}
+
+void tearDown(void)
+{
+  uint8_t i;
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_destruct(i);
+  }
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_plan_returns_err_when_end_is_off_the_circle(void)
+{
+  config.end_y = 52;
+  TEST_ASSERT(arc_plan(&arc, config) == ARC_ERR_OPTION_INVALID);
+
+  setUp();
+  config.start_x = 0;
+  config.end_x = 0;
+  config.end_y = 0;
+  TEST_ASSERT(arc_plan(&arc, config) == ARC_ERR_OPTION_INVALID);
+
+  setUp();
+  config.dir = (arc_dir_t)2;
+  TEST_ASSERT(arc_plan(&arc, config) == ARC_ERR_OPTION_INVALID);
+}
+
+void test_nextStep_quarter_circle_lands_exactly_on_end(void)
+{
+  uint16_t steps;
+  double error;
+
+  TEST_ASSERT(arc_plan(&arc, config) == ARC_ERR_NONE);
+  error = _run(&steps);
+
+  TEST_ASSERT(arc_isDone(&arc));
+  TEST_ASSERT(arc.x == 0);
+  TEST_ASSERT(arc.y == 50);
+  TEST_ASSERT(error <= 0.75);
+  // 50 steps on each axis, some of them taken together
+  TEST_ASSERT(steps >= 50);
+  TEST_ASSERT(steps <= 100);
+}
+
+void test_nextStep_clockwise_goes_the_other_way_round(void)
+{
+  uint16_t steps;
+  int8_t step_x;
+  int8_t step_y;
+
+  config.dir = ARC_DIR_CW;
+  arc_plan(&arc, config);
+  arc_nextStep(&arc, &step_x, &step_y);
+
+  TEST_ASSERT(arc.y < 0);
+  _run(&steps);
+  TEST_ASSERT(arc.x == 0);
+  TEST_ASSERT(arc.y == 50);
+  // three quarters of the way round
+  TEST_ASSERT(steps > 150);
+}
+
+void test_nextStep_full_circle_returns_to_start(void)
+{
+  uint16_t steps;
+  double error;
+
+  config.start_x = -13;
+  config.start_y = 37;
+  config.end_x = -13;
+  config.end_y = 37;
+  arc_plan(&arc, config);
+  error = _run(&steps);
+
+  TEST_ASSERT(arc.x == -13);
+  TEST_ASSERT(arc.y == 37);
+  TEST_ASSERT(error <= 0.75);
+  TEST_ASSERT(steps > 4 * 39);
+}
+
+void test_nextStep_keeps_radial_error_bounded_over_many_arcs(void)
+{
+  int16_t r;
+  int16_t x;
+  int16_t y;
+  uint8_t dir;
+  uint16_t steps;
+  double worst = 0;
+  double error;
+
+  for (r=1;r<=120;r+=7) {
+    for (x=-r;x<=r;x+=(r / 5 + 1)) {
+      y = (int16_t)lround(sqrt((double)r * r - (double)x * x));
+      for (dir=0;dir<2;dir++) {
+        config.start_x = r;
+        config.start_y = 0;
+        config.end_x = x;
+        config.end_y = (x & 1) ? y : -y;
+        config.dir = (arc_dir_t)dir;
+        if (arc_plan(&arc, config) == ARC_ERR_NONE) {
+          error = _run(&steps);
+          TEST_ASSERT(arc_isDone(&arc));
+          TEST_ASSERT(arc.x == config.end_x);
+          TEST_ASSERT(arc.y == config.end_y);
+          TEST_ASSERT(steps <= MAX_ARC_STEPS(r));
+          if (error > worst) {
+            worst = error;
+          }
+        }
+      }
+    }
+  }
+
+  TEST_ASSERT(worst <= 0.75);
+}
+
+void test_tick_drives_steppers_along_the_arc(void)
+{
+  uint16_t ticks = 0;
+
+  stepper_fixture_make(&stepper_handles[0]);
+  stepper_fixture_make(&stepper_handles[1]);
+  stepper_enable(stepper_handles[0]);
+  stepper_enable(stepper_handles[1]);
+  // centre at (100, 100), starting at (130, 100) and ending at (100, 70)
+  stepper_seedPos(stepper_handles[0], 130);
+  stepper_seedPos(stepper_handles[1], 100);
+  config.start_x = 30;
+  config.end_x = 0;
+  config.end_y = -30;
+  config.dir = ARC_DIR_CW;
+  arc_plan(&arc, config);
+
+  while (!arc_isDone(&arc) && ticks < 1000) {
+    TEST_ASSERT(
+      arc_tick(&arc, stepper_handles[0], stepper_handles[1]) == ARC_ERR_NONE
+    );
+    stepper_stepEngage(stepper_handles[0]);
+    stepper_stepEngage(stepper_handles[1]);
+    stepper_stepRelease(stepper_handles[0]);
+    stepper_stepRelease(stepper_handles[1]);
+    TEST_ASSERT(stepper_getPos(stepper_handles[0]) - 100 == arc.x);
+    TEST_ASSERT(stepper_getPos(stepper_handles[1]) - 100 == arc.y);
+    ticks++;
+  }
+
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 100);
+  TEST_ASSERT(stepper_getPos(stepper_handles[1]) == 70);
+}
+
+void test_tick_returns_err_when_handle_invalid(void)
+{
+  arc_plan(&arc, config);
+
+  TEST_ASSERT(
+    arc_tick(&arc, stepper_handles[0], stepper_handles[1])
+    == ARC_ERR_HANDLE_INVALID
+  );
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+// steps the planned arc to the end, returning the worst distance of any point
+// from the ideal circle
+static double _run(uint16_t *steps) {
+  int8_t step_x;
+  int8_t step_y;
+  double r = sqrt((double)config.start_x * config.start_x
+    + (double)config.start_y * config.start_y);
+  double error;
+  double worst = 0;
+
+  *steps = 0;
+  while (arc_nextStep(&arc, &step_x, &step_y) && *steps < 10000) {
+    TEST_ASSERT(step_x >= -1 && step_x <= 1);
+    TEST_ASSERT(step_y >= -1 && step_y <= 1);
+    error = fabs(sqrt((double)arc.x * arc.x + (double)arc.y * arc.y) - r);
+    if (error > worst) {
+      worst = error;
+    }
+    (*steps)++;
+  }
+
+  return worst;
+}
@@ -0,0 +1,106 @@
+#include "unity.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "binenc.h"
+#include "crc8.h"
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static binenc_t enc;
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  binenc_init(&enc);
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_finish_frames_records_with_header_and_crc(void)
+{
+  uint8_t targets[2] = {10, 20};
+  uint8_t size;
+  uint8_t crc = 0;
+  uint8_t i;
+
+  binenc_enable(&enc, 0x03);
+  binenc_move(&enc, 0x03, 50, targets);
+  size = binenc_finish(&enc);
+
+  TEST_ASSERT(size == BINPROTO_HEADER_SIZE + 2 + 5 + 1);
+  TEST_ASSERT(enc.frame[0] == BINPROTO_SYNC);
+  TEST_ASSERT(enc.frame[1] == 7);
+  TEST_ASSERT(enc.frame[2] == 0);
+  TEST_ASSERT(enc.frame[3] == BINPROTO_OP_ENABLE);
+  TEST_ASSERT(enc.frame[5] == BINPROTO_OP_MOVE);
+  TEST_ASSERT(enc.frame[8] == 10);
+  TEST_ASSERT(enc.frame[9] == 20);
+  for (i=1;i<size - 1;i++) {
+    crc = crc8_update(crc, enc.frame[i]);
+  }
+  TEST_ASSERT(enc.frame[size - 1] == crc);
+}
+
+void test_finish_advances_sequence(void)
+{
+  binenc_finish(&enc);
+  binenc_begin(&enc);
+  binenc_finish(&enc);
+
+  TEST_ASSERT(enc.frame[2] == 1);
+}
+
+void test_move_packs_only_the_axes_given(void)
+{
+  uint8_t target = 33;
+
+  binenc_move(&enc, 0x02, 0, &target);
+  binenc_finish(&enc);
+
+  TEST_ASSERT(enc.frame[1] == 4);
+  TEST_ASSERT(enc.frame[6] == 33);
+  TEST_ASSERT(binenc_getMoves(&enc) == 1);
+}
+
+void test_append_returns_err_when_frame_full(void)
+{
+  uint8_t i;
+
+  for (i=0;i<BINPROTO_MAX_PAYLOAD / 3;i++) {
+    TEST_ASSERT(binenc_dwell(&enc, 1) == BINENC_ERR_NONE);
+  }
+
+  TEST_ASSERT(binenc_dwell(&enc, 1) == BINENC_ERR_FRAME_FULL);
+  TEST_ASSERT(binenc_getMoves(&enc) == BINPROTO_MAX_PAYLOAD / 3);
+}
+
+void test_parseReply_returns_err_when_crc_bad(void)
+{
+  uint8_t reply[BINPROTO_REPLY_SIZE] = {BINPROTO_SYNC, 2, 5, 0, 3, 0};
+  binenc_reply_t parsed;
+  uint8_t i;
+
+  for (i=1;i<BINPROTO_REPLY_SIZE - 1;i++) {
+    reply[5] = crc8_update(reply[5], reply[i]);
+  }
+  TEST_ASSERT(
+    binenc_parseReply(reply, sizeof(reply), &parsed) == BINENC_ERR_NONE
+  );
+  TEST_ASSERT(parsed.seq == 5);
+  TEST_ASSERT(parsed.credits == 3);
+
+  reply[4]++;
+  TEST_ASSERT(
+    binenc_parseReply(reply, sizeof(reply), &parsed)
+    == BINENC_ERR_REPLY_INVALID
+  );
+}
@@ -0,0 +1,203 @@
+#include "unity.h"
+#include "stepper_fixture.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "binproto.h"
+#include "binenc.h"
+#include "crc8.h"
+#include "ringbuf.h"
+#include "motion.h"
+#include "stepper.h"
+#include "arc.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPERS 2
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static stepper_descriptor_t stepper_handles[MAX_STEPPERS];
+static ringbuf_t rx;
+static binenc_t enc;
+static binenc_reply_t reply;
+static uint8_t num_replies;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _send(const uint8_t *data, uint8_t len);
+static void _transfer(void);
+static void _onReply(const uint8_t *data, uint8_t len);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  stepper_fixture_make(&stepper_handles[0]);
+  stepper_fixture_make(&stepper_handles[1]);
+  motion_init(stepper_handles, MAX_STEPPERS);
+  ringbuf_init(&rx);
+  binproto_init(&rx, _onReply);
+  binenc_init(&enc);
+  num_replies = 0;
+}
+
+void tearDown(void)
+{
+  uint8_t i;
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_destruct(i);
+  }
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_poll_applies_settings_through_stepper_api(void)
+{
+  binenc_enable(&enc, 0x02);
+  binenc_stepSize(&enc, 1, STEPPER_STEP_SIZE_QUARTER);
+  binenc_mode(&enc, 1, STEPPER_MODE_OSCILLATE);
+  binenc_speed(&enc, 1, 77);
+  binenc_target(&enc, 1, 10, 30);
+  _transfer();
+
+  TEST_ASSERT(num_replies == 1);
+  TEST_ASSERT(reply.status == BINPROTO_STATUS_OK);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[1]) == STEPPER_STATUS_ENABLED);
+  TEST_ASSERT(
+    stepper_getStepSize(stepper_handles[1]) == STEPPER_STEP_SIZE_QUARTER
+  );
+  TEST_ASSERT(stepper_getMode(stepper_handles[1]) == STEPPER_MODE_OSCILLATE);
+  TEST_ASSERT(stepper_getSpeed(stepper_handles[1]) == 77);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[1]) == 10);
+  TEST_ASSERT(stepper_getDesiredPos2(stepper_handles[1]) == 30);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[0]) == STEPPER_STATUS_DISABLED);
+}
+
+void test_poll_queues_several_moves_from_one_frame(void)
+{
+  uint8_t targets[3][2] = {{10, 20}, {30, 40}, {50, 60}};
+  uint8_t i;
+
+  for (i=0;i<3;i++) {
+    binenc_move(&enc, 0x03, 0, targets[i]);
+  }
+  _transfer();
+
+  TEST_ASSERT(reply.status == BINPROTO_STATUS_OK);
+  TEST_ASSERT(reply.seq == 0);
+  TEST_ASSERT(reply.credits == MOTION_QUEUE_SIZE - 3);
+  motion_poll(0);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[0]) == 10);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[1]) == 20);
+}
+
+void test_poll_rejects_frame_with_bad_crc(void)
+{
+  binenc_enable(&enc, 0x01);
+  binenc_finish(&enc);
+  enc.frame[3] ^= 0x10;
+  _send(enc.frame, BINPROTO_HEADER_SIZE + 2 + 1);
+  binproto_poll();
+
+  TEST_ASSERT(reply.status == BINPROTO_STATUS_CRC);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[0]) == STEPPER_STATUS_DISABLED);
+  TEST_ASSERT(binproto_getErrors() == 1);
+}
+
+void test_poll_runs_a_resent_frame_only_once(void)
+{
+  uint8_t target = 5;
+  uint8_t size;
+
+  binenc_move(&enc, 0x01, 0, &target);
+  size = binenc_finish(&enc);
+  _send(enc.frame, size);
+  _send(enc.frame, size);
+  binproto_poll();
+
+  TEST_ASSERT(num_replies == 2);
+  TEST_ASSERT(reply.status == BINPROTO_STATUS_OK);
+  TEST_ASSERT(reply.credits == MOTION_QUEUE_SIZE - 1);
+  TEST_ASSERT(binproto_getFrames() == 1);
+}
+
+void test_poll_reports_expected_sequence_when_frames_skipped(void)
+{
+  binenc_finish(&enc);
+  binenc_begin(&enc);
+  binenc_enable(&enc, 0x01);
+  _transfer();
+
+  TEST_ASSERT(reply.status == BINPROTO_STATUS_SEQUENCE);
+  TEST_ASSERT(reply.seq == 0);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[0]) == STEPPER_STATUS_DISABLED);
+}
+
+void test_poll_rejects_whole_frame_with_an_invalid_record(void)
+{
+  uint8_t target = 200;
+
+  binenc_enable(&enc, 0x01);
+  binenc_move(&enc, 0x01, 0, &target);
+  _transfer();
+
+  TEST_ASSERT(reply.status == BINPROTO_STATUS_INVALID);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[0]) == STEPPER_STATUS_DISABLED);
+  TEST_ASSERT(reply.credits == MOTION_QUEUE_SIZE);
+}
+
+void test_poll_rejects_frame_with_more_moves_than_credits(void)
+{
+  uint8_t i;
+
+  for (i=0;i<MOTION_QUEUE_SIZE + 1;i++) {
+    binenc_dwell(&enc, 10);
+  }
+  _transfer();
+
+  TEST_ASSERT(reply.status == BINPROTO_STATUS_FULL);
+  TEST_ASSERT(reply.credits == MOTION_QUEUE_SIZE);
+  TEST_ASSERT(motion_isIdle() == 1);
+}
+
+void test_poll_resyncs_after_line_noise(void)
+{
+  uint8_t noise[4] = {0x00, BINPROTO_SYNC, 0xFF, 0x42};
+
+  _send(noise, sizeof(noise));
+  binenc_enable(&enc, 0x01);
+  _transfer();
+
+  TEST_ASSERT(reply.status == BINPROTO_STATUS_OK);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[0]) == STEPPER_STATUS_ENABLED);
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static void _send(const uint8_t *data, uint8_t len) {
+  uint8_t i;
+
+  for (i=0;i<len;i++) {
+    ringbuf_put(&rx, data[i]);
+  }
+}
+
+// seals the open frame and delivers it to the device
+static void _transfer(void) {
+  uint8_t size = binenc_finish(&enc);
+
+  _send(enc.frame, size);
+  binproto_poll();
+}
+
+static void _onReply(const uint8_t *data, uint8_t len) {
+  TEST_ASSERT(binenc_parseReply(data, len, &reply) == BINENC_ERR_NONE);
+  num_replies++;
+}
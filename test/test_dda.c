@@ -0,0 +1,197 @@
+#include "unity.h"
+#include "stepper_fixture.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "dda.h"
+#include "stepper.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPERS 2
+#define MAX_TICKS 400
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static stepper_descriptor_t stepper_handles[MAX_STEPPERS];
+static dda_t dda;
+static dda_attr_t config;
+
+// the tick each motor made each of its steps on
+static uint16_t step_ticks[MAX_STEPPERS][MAX_TICKS];
+static uint16_t num_steps[MAX_STEPPERS];
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static uint16_t _run(void);
+static uint8_t _isStepTick(uint8_t axis, uint16_t tick);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  uint8_t i;
+
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_fixture_make(&stepper_handles[i]);
+    stepper_enable(stepper_handles[i]);
+  }
+
+  config.steps[0] = 8;
+  config.steps[1] = 3;
+  config.num_axes = 2;
+  config.interval = 4;
+  config.max_level = DDA_MAX_LEVEL;
+}
+
+void tearDown(void)
+{
+  uint8_t i;
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_destruct(i);
+  }
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_plan_returns_err_when_option_invalid(void)
+{
+  config.num_axes = 0;
+  TEST_ASSERT(dda_plan(&dda, config) == DDA_ERR_OPTION_INVALID);
+  config.num_axes = DDA_MAX_AXES + 1;
+  TEST_ASSERT(dda_plan(&dda, config) == DDA_ERR_OPTION_INVALID);
+  config.num_axes = 2;
+  config.interval = 0;
+  TEST_ASSERT(dda_plan(&dda, config) == DDA_ERR_OPTION_INVALID);
+  config.interval = 4;
+  config.max_level = DDA_MAX_LEVEL + 1;
+  TEST_ASSERT(dda_plan(&dda, config) == DDA_ERR_OPTION_INVALID);
+}
+
+void test_tick_returns_err_when_handle_invalid(void)
+{
+  dda_plan(&dda, config);
+  stepper_destruct(1);
+
+  TEST_ASSERT(dda_tick(&dda, stepper_handles) == DDA_ERR_HANDLE_INVALID);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[0]) == 0);
+}
+
+void test_plan_oversamples_more_as_interval_grows(void)
+{
+  config.interval = 1;
+  dda_plan(&dda, config);
+  TEST_ASSERT(dda_getLevel(&dda) == 0);
+
+  config.interval = 6;
+  dda_plan(&dda, config);
+  TEST_ASSERT(dda_getLevel(&dda) == 2);
+
+  config.max_level = 1;
+  dda_plan(&dda, config);
+  TEST_ASSERT(dda_getLevel(&dda) == 1);
+
+  config.interval = 1000;
+  config.max_level = DDA_MAX_LEVEL;
+  dda_plan(&dda, config);
+  TEST_ASSERT(dda_getLevel(&dda) == DDA_MAX_LEVEL);
+}
+
+void test_tick_without_oversampling_steps_slow_axis_with_fast_one(void)
+{
+  uint8_t i;
+
+  config.max_level = 0;
+  dda_plan(&dda, config);
+
+  TEST_ASSERT(_run() == 29);
+  TEST_ASSERT(num_steps[0] == 8);
+  TEST_ASSERT(num_steps[1] == 3);
+  for (i=0;i<num_steps[1];i++) {
+    TEST_ASSERT(_isStepTick(0, step_ticks[1][i]));
+  }
+}
+
+void test_tick_oversampling_puts_slow_axis_between_fast_steps(void)
+{
+  uint8_t between = 0;
+  uint8_t i;
+
+  dda_plan(&dda, config);
+  TEST_ASSERT(dda_getLevel(&dda) == 2);
+
+  _run();
+  TEST_ASSERT(num_steps[0] == 8);
+  TEST_ASSERT(num_steps[1] == 3);
+  // the fast axis keeps its rate
+  for (i=1;i<num_steps[0];i++) {
+    TEST_ASSERT(step_ticks[0][i] - step_ticks[0][i - 1] == 4);
+  }
+  for (i=0;i<num_steps[1];i++) {
+    if (!_isStepTick(0, step_ticks[1][i])) {
+      between++;
+    }
+  }
+  TEST_ASSERT(between > 0);
+}
+
+void test_tick_steps_exactly_in_both_directions(void)
+{
+  config.steps[0] = -5;
+  config.steps[1] = 7;
+  config.interval = 3;
+  stepper_seedPos(stepper_handles[0], 2);
+  dda_plan(&dda, config);
+
+  _run();
+  TEST_ASSERT(dda_isDone(&dda));
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 197);
+  TEST_ASSERT(stepper_getDir(stepper_handles[0]) == STEPPER_DIR_REVERSE);
+  TEST_ASSERT(stepper_getPos(stepper_handles[1]) == 7);
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+// ticks the segment through as the step timer isr would, noting every step,
+// and returns the ticks taken
+static uint16_t _run(void) {
+  uint16_t tick = 0;
+  uint8_t pos;
+  uint8_t i;
+
+  num_steps[0] = 0;
+  num_steps[1] = 0;
+  while (!dda_isDone(&dda) && tick < MAX_TICKS) {
+    dda_tick(&dda, stepper_handles);
+    for (i=0;i<MAX_STEPPERS;i++) {
+      pos = stepper_getPos(stepper_handles[i]);
+      stepper_stepEngage(stepper_handles[i]);
+      stepper_stepRelease(stepper_handles[i]);
+      if (stepper_getPos(stepper_handles[i]) != pos) {
+        step_ticks[i][num_steps[i]++] = tick;
+      }
+    }
+    tick++;
+  }
+
+  return tick;
+}
+
+static uint8_t _isStepTick(uint8_t axis, uint16_t tick) {
+  uint8_t found = 0;
+  uint16_t i;
+
+  for (i=0;i<num_steps[axis];i++) {
+    if (step_ticks[axis][i] == tick) {
+      found = 1;
+    }
+  }
+
+  return found;
+}
@@ -0,0 +1,292 @@
+#include "unity.h"
+#include "fake_encoder.h"
+#include "stepper_fixture.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "encoder.h"
+#include "stepper.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_ENCODERS 2
+#define MAX_STEPPERS 2
+#define MAX_STEPPER_POS 199
+#define COUNTS_PER_STEP 4
+#define MAX_ERROR 1
+#define A_PIN 2
+#define B_PIN 5
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static uint8_t pin_reg;
+static uint8_t pin_ddr;
+
+static stepper_descriptor_t stepper_handle;
+static encoder_descriptor_t encoder_handle;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static encoder_err_t _makeEncoder(uint8_t correct);
+static void _step(uint8_t count, uint8_t moves);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  pin_reg = 0;
+  pin_ddr = 0xFF;
+  fake_encoder_init(&pin_reg, A_PIN, B_PIN);
+  stepper_fixture_make(&stepper_handle);
+}
+
+void tearDown(void)
+{
+  uint8_t i;
+  for (i=0;i<MAX_ENCODERS;i++) {
+    encoder_destruct(i);
+  }
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_destruct(i);
+  }
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_construct_configures_pins_as_inputs(void)
+{
+  _makeEncoder(0);
+
+  TEST_ASSERT((pin_ddr & (1 << A_PIN)) == 0);
+  TEST_ASSERT((pin_ddr & (1 << B_PIN)) == 0);
+  TEST_ASSERT(encoder_getStatus(encoder_handle) == ENCODER_STATUS_TRACKING);
+}
+
+void test_construct_returns_err_if_none_available(void)
+{
+  _makeEncoder(0);
+  _makeEncoder(0);
+
+  TEST_ASSERT(_makeEncoder(0) == ENCODER_ERR_NONE_AVAILABLE);
+}
+
+void test_construct_returns_err_when_counts_per_step_invalid(void)
+{
+  encoder_attr_t config;
+  config.pin_reg = &pin_reg;
+  config.pin_ddr = &pin_ddr;
+  config.counts_per_step = 0;
+
+  TEST_ASSERT(
+    encoder_construct(config, &encoder_handle)
+    == ENCODER_ERR_OPTION_INVALID
+  );
+}
+
+void test_construct_returns_err_when_stepper_invalid(void)
+{
+  encoder_attr_t config;
+  config.pin_reg = &pin_reg;
+  config.pin_ddr = &pin_ddr;
+  config.a_pin = A_PIN;
+  config.b_pin = B_PIN;
+  config.counts_per_step = COUNTS_PER_STEP;
+  config.max_error = MAX_ERROR;
+  config.correct = 0;
+
+  config.stepper = MAX_STEPPERS;
+  TEST_ASSERT(
+    encoder_construct(config, &encoder_handle)
+    == ENCODER_ERR_HANDLE_INVALID
+  );
+
+  stepper_destruct(stepper_handle);
+  config.stepper = stepper_handle;
+  TEST_ASSERT(
+    encoder_construct(config, &encoder_handle)
+    == ENCODER_ERR_HANDLE_INVALID
+  );
+}
+
+void test_construct_starts_at_stepper_position(void)
+{
+  stepper_enable(stepper_handle);
+  stepper_setPos(stepper_handle, 3, 0);
+  _step(3, 0);
+
+  _makeEncoder(0);
+
+  TEST_ASSERT(encoder_getPos(encoder_handle) == 3);
+  TEST_ASSERT(encoder_getFollowingError(encoder_handle) == 0);
+}
+
+void test_update_counts_forward_and_reverse(void)
+{
+  uint8_t i;
+  _makeEncoder(0);
+
+  for (i=0;i<2 * COUNTS_PER_STEP;i++) {
+    fake_encoder_count(1);
+    encoder_update(encoder_handle);
+  }
+  TEST_ASSERT(encoder_getPos(encoder_handle) == 2);
+
+  for (i=0;i<COUNTS_PER_STEP;i++) {
+    fake_encoder_count(-1);
+    encoder_update(encoder_handle);
+  }
+  TEST_ASSERT(encoder_getPos(encoder_handle) == 1);
+}
+
+void test_update_wraps_below_zero(void)
+{
+  _makeEncoder(0);
+
+  fake_encoder_count(-1);
+  encoder_update(encoder_handle);
+
+  TEST_ASSERT(encoder_getPos(encoder_handle) == MAX_STEPPER_POS);
+}
+
+void test_update_counts_glitches_without_moving(void)
+{
+  _makeEncoder(0);
+
+  fake_encoder_glitch();
+  encoder_update(encoder_handle);
+
+  TEST_ASSERT(encoder_getGlitches(encoder_handle) == 1);
+  TEST_ASSERT(encoder_getPos(encoder_handle) == 0);
+}
+
+void test_check_keeps_tracking_within_max_error(void)
+{
+  _makeEncoder(0);
+  stepper_enable(stepper_handle);
+  stepper_setPos(stepper_handle, 10, 0);
+
+  _step(10, 9);
+  encoder_check(encoder_handle);
+
+  TEST_ASSERT(encoder_getFollowingError(encoder_handle) == 1);
+  TEST_ASSERT(encoder_getStatus(encoder_handle) == ENCODER_STATUS_TRACKING);
+}
+
+void test_check_latches_fault_on_lost_steps(void)
+{
+  _makeEncoder(0);
+  stepper_enable(stepper_handle);
+  stepper_setPos(stepper_handle, 10, 0);
+
+  _step(10, 7);
+  encoder_check(encoder_handle);
+
+  TEST_ASSERT(encoder_getFollowingError(encoder_handle) == 3);
+  TEST_ASSERT(encoder_getStatus(encoder_handle) == ENCODER_STATUS_FAULT);
+  TEST_ASSERT(stepper_getCorrectionPending(stepper_handle) == 0);
+
+  encoder_clearFault(encoder_handle);
+  TEST_ASSERT(encoder_getStatus(encoder_handle) == ENCODER_STATUS_TRACKING);
+}
+
+void test_check_corrects_lost_steps_when_enabled(void)
+{
+  _makeEncoder(1);
+  stepper_enable(stepper_handle);
+  stepper_setPos(stepper_handle, 10, 0);
+
+  _step(10, 7);
+  encoder_check(encoder_handle);
+  TEST_ASSERT(stepper_getCorrectionPending(stepper_handle) == 3);
+
+  // the axis is already at its target, the correction still goes out
+  _step(3, 3);
+  TEST_ASSERT(stepper_getPos(stepper_handle) == 10);
+  TEST_ASSERT(encoder_getFollowingError(encoder_handle) == 0);
+}
+
+void test_check_corrects_lost_steps_in_reverse(void)
+{
+  _makeEncoder(1);
+  stepper_enable(stepper_handle);
+  stepper_setPos(stepper_handle, MAX_STEPPER_POS - 2, 0);
+  stepper_setDir(stepper_handle, STEPPER_DIR_REVERSE);
+
+  _step(3, 0);
+  encoder_check(encoder_handle);
+
+  TEST_ASSERT(encoder_getFollowingError(encoder_handle) == -3);
+  TEST_ASSERT(stepper_getCorrectionPending(stepper_handle) == 3);
+}
+
+void test_check_doesnt_correct_against_direction_of_travel(void)
+{
+  uint8_t i;
+  _makeEncoder(1);
+  stepper_enable(stepper_handle);
+
+  // the axis gets pushed forward while the stepper holds still
+  for (i=0;i<3 * COUNTS_PER_STEP;i++) {
+    fake_encoder_count(1);
+    encoder_update(encoder_handle);
+  }
+  encoder_check(encoder_handle);
+
+  TEST_ASSERT(encoder_getFollowingError(encoder_handle) == -3);
+  TEST_ASSERT(encoder_getStatus(encoder_handle) == ENCODER_STATUS_FAULT);
+  TEST_ASSERT(stepper_getCorrectionPending(stepper_handle) == 0);
+}
+
+void test_check_returns_error_when_handle_invalid(void)
+{
+  uint8_t invalid_handle = 3;
+  _makeEncoder(0);
+
+  TEST_ASSERT(encoder_check(invalid_handle) == ENCODER_ERR_HANDLE_INVALID);
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static encoder_err_t _makeEncoder(uint8_t correct) {
+  encoder_attr_t config;
+  config.pin_reg = &pin_reg;
+  config.pin_ddr = &pin_ddr;
+  config.a_pin = A_PIN;
+  config.b_pin = B_PIN;
+
+  config.stepper = stepper_handle;
+  config.counts_per_step = COUNTS_PER_STEP;
+  config.max_error = MAX_ERROR;
+  config.correct = correct;
+
+  return encoder_construct(config, &encoder_handle);
+}
+
+// issues count step pulses of which only the first moves actually turn the
+// encoder, the rest are lost
+static void _step(uint8_t count, uint8_t moves) {
+  uint8_t i;
+  uint8_t j;
+  int8_t dir = 1;
+
+  if (stepper_getDir(stepper_handle) == STEPPER_DIR_REVERSE) {
+    dir = -1;
+  }
+
+  for (i=0;i<count;i++) {
+    stepper_stepEngage(stepper_handle);
+    stepper_stepRelease(stepper_handle);
+    if (i < moves) {
+      for (j=0;j<COUNTS_PER_STEP;j++) {
+        fake_encoder_count(dir);
+        encoder_update(encoder_handle);
+      }
+    }
+  }
+}
@@ -0,0 +1,234 @@
+#include "unity.h"
+#include "stepper_fixture.h"
+#include <string.h>
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "gcode.h"
+#include "ringbuf.h"
+#include "motion.h"
+#include "stepper.h"
+#include "arc.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPERS 2
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static stepper_descriptor_t stepper_handles[MAX_STEPPERS];
+static ringbuf_t rx;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _send(const char *text);
+static void _run(void);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  stepper_fixture_make(&stepper_handles[0]);
+  stepper_fixture_make(&stepper_handles[1]);
+  motion_init(stepper_handles, MAX_STEPPERS);
+  ringbuf_init(&rx);
+  gcode_init(&rx);
+}
+
+void tearDown(void)
+{
+  uint8_t i;
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_destruct(i);
+  }
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_poll_queues_linear_move(void)
+{
+  _send("M17\nG1 X12 Y7.6 F30\n");
+  _run();
+
+  TEST_ASSERT(gcode_getLines() == 2);
+  TEST_ASSERT(gcode_getErrors() == 0);
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 12);
+  TEST_ASSERT(stepper_getPos(stepper_handles[1]) == 8);
+  TEST_ASSERT(stepper_getSpeed(stepper_handles[0]) == 30);
+}
+
+void test_poll_waits_for_the_end_of_a_line(void)
+{
+  _send("G1 X1");
+  gcode_poll();
+  TEST_ASSERT(motion_getFree() == MOTION_QUEUE_SIZE);
+
+  _send("0\n");
+  gcode_poll();
+  TEST_ASSERT(motion_getFree() == MOTION_QUEUE_SIZE - 1);
+}
+
+void test_poll_moves_relative_in_g91(void)
+{
+  _send("M17\nG1 X50\nG91\nG1 X-20\nX5\nG90 X7\n");
+  _run();
+
+  TEST_ASSERT(gcode_getErrors() == 0);
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 7);
+}
+
+void test_poll_homes_given_axes_or_all(void)
+{
+  _send("M17\nG1 X30 Y40\nG28 Y0\n");
+  _run();
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 30);
+  TEST_ASSERT(stepper_getPos(stepper_handles[1]) == 0);
+
+  _send("G1 Y9\nG28\n");
+  _run();
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 0);
+  TEST_ASSERT(stepper_getPos(stepper_handles[1]) == 0);
+}
+
+void test_poll_queues_dwell_in_ms(void)
+{
+  _send("G4 P250\n");
+  gcode_poll();
+  motion_poll(0);
+  motion_poll(249);
+  TEST_ASSERT(motion_isIdle() == 0);
+  motion_poll(250);
+  TEST_ASSERT(motion_isIdle() == 1);
+
+  _send("G4 S1.5\n");
+  gcode_poll();
+  motion_poll(0);
+  motion_poll(1499);
+  TEST_ASSERT(motion_isIdle() == 0);
+  motion_poll(1500);
+  TEST_ASSERT(motion_isIdle() == 1);
+}
+
+void test_poll_enables_and_disables_steppers(void)
+{
+  _send("M17 Y0\n");
+  _run();
+  TEST_ASSERT(stepper_getStatus(stepper_handles[0]) == STEPPER_STATUS_DISABLED);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[1]) == STEPPER_STATUS_ENABLED);
+
+  _send("M17\nM18\n");
+  _run();
+  TEST_ASSERT(stepper_getStatus(stepper_handles[0]) == STEPPER_STATUS_DISABLED);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[1]) == STEPPER_STATUS_DISABLED);
+}
+
+void test_poll_skips_comments_and_line_numbers(void)
+{
+  _send("; setup\nN10 M17 (both axes)*71\r\nN11 G0 (go) X3 ; there\n");
+  _run();
+
+  TEST_ASSERT(gcode_getErrors() == 0);
+  TEST_ASSERT(gcode_getLines() == 2);
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 3);
+}
+
+void test_poll_rejects_bad_lines_and_carries_on(void)
+{
+  _send("M17\nG1 X-1\n");
+  _run();
+  TEST_ASSERT(gcode_getLastError() == GCODE_ERR_RANGE);
+
+  _send("G5 X5\n");
+  _run();
+  TEST_ASSERT(gcode_getLastError() == GCODE_ERR_UNSUPPORTED);
+
+  _send("G1 X5 #\n");
+  _run();
+  TEST_ASSERT(gcode_getLastError() == GCODE_ERR_SYNTAX);
+
+  _send("G1 X1 X2 X3 X4 X5 X6 X7 X8\n");
+  _run();
+  TEST_ASSERT(gcode_getLastError() == GCODE_ERR_TOO_LONG);
+
+  _send("G1 X9\n");
+  _run();
+  TEST_ASSERT(gcode_getErrors() == 4);
+  TEST_ASSERT(gcode_getLines() == 2);
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 9);
+}
+
+void test_poll_runs_arcs_around_a_relative_centre(void)
+{
+  uint8_t i;
+  uint16_t now = 0;
+
+  _send("M17\nG1 X80 Y50\nG3 X50 Y80 I-30 J0\nG2 X80 Y50 I0 J-30\n");
+  gcode_poll();
+  do {
+    motion_poll(now++);
+    motion_tick();
+    for (i=0;i<MAX_STEPPERS;i++) {
+      stepper_stepEngage(stepper_handles[i]);
+      stepper_stepRelease(stepper_handles[i]);
+    }
+  } while (!motion_isIdle());
+
+  TEST_ASSERT(gcode_getErrors() == 0);
+  TEST_ASSERT(gcode_getLines() == 4);
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 80);
+  TEST_ASSERT(stepper_getPos(stepper_handles[1]) == 50);
+}
+
+void test_poll_rejects_arc_that_misses_its_end(void)
+{
+  _send("G1 X80 Y50\nG3 X50 Y90 I-30\n");
+  gcode_poll();
+
+  TEST_ASSERT(gcode_getLastError() == GCODE_ERR_RANGE);
+  TEST_ASSERT(motion_getFree() == MOTION_QUEUE_SIZE - 1);
+}
+
+void test_poll_stops_reading_while_motion_queue_full(void)
+{
+  uint8_t i;
+
+  for (i=0;i<MOTION_QUEUE_SIZE + 1;i++) {
+    _send("G4 P10\n");
+  }
+  gcode_poll();
+
+  TEST_ASSERT(motion_getFree() == 0);
+  TEST_ASSERT(gcode_getLines() == MOTION_QUEUE_SIZE);
+  TEST_ASSERT(ringbuf_getCount(&rx) == strlen("G4 P10\n"));
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static void _send(const char *text) {
+  while (*text != '\0') {
+    ringbuf_put(&rx, (uint8_t)*text);
+    text++;
+  }
+}
+
+// stands in for the main loop and step timer until everything sent is done
+static void _run(void) {
+  uint8_t i;
+  uint16_t now = 0;
+
+  do {
+    gcode_poll();
+    motion_poll(now);
+    for (i=0;i<MAX_STEPPERS;i++) {
+      stepper_stepEngage(stepper_handles[i]);
+      stepper_stepRelease(stepper_handles[i]);
+    }
+    now++;
+  } while (ringbuf_getCount(&rx) > 0 || !motion_isIdle());
+}
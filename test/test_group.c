@@ -0,0 +1,208 @@
+#include "unity.h"
+#include "stepper_fixture.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "group.h"
+#include "stepper.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPERS 2
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+// both steppers share one port, pins 0..5 for the first and 6..7 for the
+// second's dir and enable
+static uint8_t stepper_port;
+static uint8_t stepper_port_ddr;
+static uint8_t ms_port;
+static uint8_t ms_port_ddr;
+static stepper_descriptor_t stepper_handles[MAX_STEPPERS];
+static group_t group;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _makeStepper(uint8_t handle_index, uint8_t dir_pin);
+static void _tick(void);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  _makeStepper(0, 0);
+  _makeStepper(1, 6);
+  group_init(&group, stepper_handles, MAX_STEPPERS);
+}
+
+void tearDown(void)
+{
+  uint8_t i;
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_destruct(i);
+  }
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_init_returns_err_when_handle_invalid(void)
+{
+  stepper_descriptor_t handles[] = {0, 3};
+
+  TEST_ASSERT(
+    group_init(&group, stepper_handles, GROUP_MAX_AXES + 1)
+    == GROUP_ERR_AXIS_INVALID
+  );
+  TEST_ASSERT(group_init(&group, handles, 2) == GROUP_ERR_HANDLE_INVALID);
+  handles[1] = 0;
+  TEST_ASSERT(group_init(&group, handles, 2) == GROUP_ERR_HANDLE_INVALID);
+}
+
+void test_stage_returns_err_when_axis_or_option_invalid(void)
+{
+  TEST_ASSERT(
+    group_stageTarget(&group, 2, 10, 0, STEPPER_DIR_FORWARD)
+    == GROUP_ERR_AXIS_INVALID
+  );
+  TEST_ASSERT(
+    group_stageTarget(&group, 0, 200, 0, STEPPER_DIR_FORWARD)
+    == GROUP_ERR_OPTION_INVALID
+  );
+  TEST_ASSERT(
+    group_stageMode(&group, 0, (stepper_mode_t)3)
+    == GROUP_ERR_OPTION_INVALID
+  );
+}
+
+void test_stage_returns_err_while_commit_pending(void)
+{
+  group_stageSpeed(&group, 0, 10);
+  group_commit(&group);
+
+  TEST_ASSERT(group_stageSpeed(&group, 1, 10) == GROUP_ERR_BUSY);
+  group_tick(&group);
+  TEST_ASSERT(group_isCommitPending(&group) == 0);
+  TEST_ASSERT(group_stageSpeed(&group, 1, 10) == GROUP_ERR_NONE);
+}
+
+void test_tick_applies_staged_changes_together_on_commit(void)
+{
+  group_stageEnable(&group, 0, 1);
+  group_stageEnable(&group, 1, 1);
+  group_stageTarget(&group, 0, 5, 0, STEPPER_DIR_FORWARD);
+  group_stageTarget(&group, 1, 195, 0, STEPPER_DIR_REVERSE);
+  group_stageMode(&group, 1, STEPPER_MODE_OSCILLATE);
+  group_stageSpeed(&group, 0, 30);
+
+  // staging alone changes nothing
+  _tick();
+  TEST_ASSERT(stepper_getStatus(0) == STEPPER_STATUS_DISABLED);
+  TEST_ASSERT(stepper_getDesiredPos1(1) == 0);
+
+  group_commit(&group);
+  TEST_ASSERT(stepper_getStatus(0) == STEPPER_STATUS_DISABLED);
+  _tick();
+
+  TEST_ASSERT(stepper_getStatus(0) == STEPPER_STATUS_ENABLED);
+  TEST_ASSERT(stepper_getStatus(1) == STEPPER_STATUS_ENABLED);
+  TEST_ASSERT((stepper_port & ((1 << 1) | (1 << 7))) == 0);
+  TEST_ASSERT(stepper_port & (1 << 6));
+  TEST_ASSERT((stepper_port & (1 << 0)) == 0);
+  TEST_ASSERT(stepper_getMode(1) == STEPPER_MODE_OSCILLATE);
+  TEST_ASSERT(stepper_getSpeed(0) == 30);
+
+  // both axes took their first step on the commit tick
+  TEST_ASSERT(stepper_getPos(0) == 1);
+  TEST_ASSERT(stepper_getPos(1) == 199);
+}
+
+void test_tick_leaves_unstaged_axes_alone(void)
+{
+  stepper_enable(1);
+  stepper_setDir(1, STEPPER_DIR_REVERSE);
+
+  group_stageEnable(&group, 0, 1);
+  group_stageTarget(&group, 0, 5, 0, STEPPER_DIR_FORWARD);
+  group_commit(&group);
+  group_tick(&group);
+
+  TEST_ASSERT(stepper_getStatus(1) == STEPPER_STATUS_ENABLED);
+  TEST_ASSERT(stepper_getDir(1) == STEPPER_DIR_REVERSE);
+  TEST_ASSERT(stepper_port & (1 << 6));
+}
+
+void test_stop_halts_and_disables_every_axis(void)
+{
+  uint8_t i;
+
+  stepper_enable(0);
+  stepper_enable(1);
+  stepper_setPos(0, 50, 0);
+  stepper_setMode(1, STEPPER_MODE_CONTINUOUS);
+  for (i=0;i<10;i++) {
+    _tick();
+  }
+  group_stageSpeed(&group, 0, 10);
+  group_commit(&group);
+
+  group_stop(&group);
+  _tick();
+
+  TEST_ASSERT(stepper_getPos(0) == 10);
+  TEST_ASSERT(stepper_getDesiredPos1(0) == 10);
+  TEST_ASSERT(stepper_getMode(1) == STEPPER_MODE_NORMAL);
+  TEST_ASSERT(stepper_getPos(1) == 10);
+  TEST_ASSERT(stepper_getStatus(0) == STEPPER_STATUS_DISABLED);
+  TEST_ASSERT(stepper_getStatus(1) == STEPPER_STATUS_DISABLED);
+  TEST_ASSERT(stepper_port & (1 << 1));
+  TEST_ASSERT(stepper_port & (1 << 7));
+  TEST_ASSERT(group_isCommitPending(&group) == 0);
+  TEST_ASSERT(stepper_getSpeed(0) == 0);
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static void _makeStepper(uint8_t handle_index, uint8_t dir_pin) {
+  stepper_attr_t config;
+
+  config = stepper_fixture_attr(&stepper_port, &stepper_port_ddr);
+  // dir and enable stay on the port the tests read back, the step and
+  // microstep lines move to a port of their own
+  config.dir_pin = dir_pin;
+  config.enable_pin = dir_pin + 1;
+
+  config.step_port = &ms_port;
+  config.step_port_ddr = &ms_port_ddr;
+  config.step_pin = 2 + handle_index;
+
+  config.ms1_port = &ms_port;
+  config.ms1_port_ddr = &ms_port_ddr;
+  config.ms1_pin = 4;
+
+  config.ms2_port = &ms_port;
+  config.ms2_port_ddr = &ms_port_ddr;
+  config.ms2_pin = 5;
+
+  config.ms3_port = &ms_port;
+  config.ms3_port_ddr = &ms_port_ddr;
+  config.ms3_pin = 6;
+
+  stepper_construct(config, &stepper_handles[handle_index]);
+}
+
+// what the step timer isr does each tick
+static void _tick(void) {
+  uint8_t i;
+
+  group_tick(&group);
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_stepEngage(stepper_handles[i]);
+    stepper_stepRelease(stepper_handles[i]);
+  }
+}
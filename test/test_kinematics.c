@@ -0,0 +1,75 @@
+#include "unity.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+// the transform is chosen at build time, this file checks the corexy one
+#define KINEMATICS_COREXY
+#include "kinematics.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define NUM_AXES 3
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static int16_t axes[NUM_AXES];
+static int16_t motors[NUM_AXES];
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  uint8_t i;
+  for (i=0;i<NUM_AXES;i++) {
+    axes[i] = 0;
+    motors[i] = 0;
+  }
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_toMotors_x_move_turns_both_motors_the_same_way(void)
+{
+  axes[0] = 10;
+  kinematics_toMotors(axes, motors, NUM_AXES);
+
+  TEST_ASSERT(KINEMATICS_COUPLED);
+  TEST_ASSERT(motors[0] == 10);
+  TEST_ASSERT(motors[1] == 10);
+}
+
+void test_toMotors_y_move_turns_motors_in_opposite_ways(void)
+{
+  axes[1] = 10;
+  kinematics_toMotors(axes, motors, NUM_AXES);
+
+  TEST_ASSERT(motors[0] == 10);
+  TEST_ASSERT(motors[1] == -10);
+}
+
+void test_toMotors_diagonal_move_needs_one_motor(void)
+{
+  axes[0] = -7;
+  axes[1] = -7;
+  kinematics_toMotors(axes, motors, NUM_AXES);
+
+  TEST_ASSERT(motors[0] == -14);
+  TEST_ASSERT(motors[1] == 0);
+}
+
+void test_toMotors_passes_further_axes_straight_through(void)
+{
+  axes[0] = 3;
+  axes[2] = -42;
+  kinematics_toMotors(axes, motors, NUM_AXES);
+
+  TEST_ASSERT(motors[2] == -42);
+}
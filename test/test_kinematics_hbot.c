@@ -0,0 +1,48 @@
+#include "unity.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+// the transform is chosen at build time, this file checks the h-bot one
+#define KINEMATICS_HBOT
+#include "kinematics.h"
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static int16_t axes[2];
+static int16_t motors[2];
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  axes[0] = 0;
+  axes[1] = 0;
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_toMotors_x_move_turns_motors_in_opposite_ways(void)
+{
+  axes[0] = 25;
+  kinematics_toMotors(axes, motors, 2);
+
+  TEST_ASSERT(KINEMATICS_COUPLED);
+  TEST_ASSERT(motors[0] == 25);
+  TEST_ASSERT(motors[1] == -25);
+}
+
+void test_toMotors_y_move_turns_both_motors_the_same_way(void)
+{
+  axes[1] = -25;
+  kinematics_toMotors(axes, motors, 2);
+
+  TEST_ASSERT(motors[0] == -25);
+  TEST_ASSERT(motors[1] == -25);
+}
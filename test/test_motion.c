@@ -0,0 +1,233 @@
+#include "unity.h"
+#include "stepper_fixture.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "motion.h"
+#include "stepper.h"
+#include "arc.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPERS 2
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static stepper_descriptor_t stepper_handles[MAX_STEPPERS];
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static motion_cmd_t _move(uint8_t axes, uint8_t x, uint8_t y);
+static void _step(void);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  stepper_fixture_make(&stepper_handles[0]);
+  stepper_fixture_make(&stepper_handles[1]);
+  motion_init(stepper_handles, MAX_STEPPERS);
+}
+
+void tearDown(void)
+{
+  uint8_t i;
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_destruct(i);
+  }
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_init_returns_err_when_too_many_axes(void)
+{
+  TEST_ASSERT(
+    motion_init(stepper_handles, MOTION_MAX_AXES + 1)
+    == MOTION_ERR_AXIS_INVALID
+  );
+}
+
+void test_push_returns_err_when_axis_invalid(void)
+{
+  motion_cmd_t cmd = _move(0x04, 0, 0);
+
+  TEST_ASSERT(motion_push(&cmd) == MOTION_ERR_AXIS_INVALID);
+}
+
+void test_push_returns_err_when_queue_full(void)
+{
+  uint8_t i;
+  motion_cmd_t cmd = _move(0x01, 10, 0);
+
+  for (i=0;i<MOTION_QUEUE_SIZE;i++) {
+    TEST_ASSERT(motion_push(&cmd) == MOTION_ERR_NONE);
+  }
+
+  TEST_ASSERT(motion_getFree() == 0);
+  TEST_ASSERT(motion_push(&cmd) == MOTION_ERR_QUEUE_FULL);
+}
+
+void test_poll_starts_move_and_sets_direction(void)
+{
+  motion_cmd_t cmd = _move(0x03, 20, 0);
+
+  stepper_seedPos(stepper_handles[1], 50);
+  motion_push(&cmd);
+  motion_poll(0);
+
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[0]) == 20);
+  TEST_ASSERT(stepper_getDir(stepper_handles[0]) == STEPPER_DIR_FORWARD);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[1]) == 0);
+  TEST_ASSERT(stepper_getDir(stepper_handles[1]) == STEPPER_DIR_REVERSE);
+  TEST_ASSERT(motion_isIdle() == 0);
+}
+
+void test_poll_waits_for_move_before_starting_next(void)
+{
+  uint8_t i;
+  motion_cmd_t first = _move(0x01, 5, 0);
+  motion_cmd_t second = _move(0x01, 2, 0);
+
+  stepper_enable(stepper_handles[0]);
+  motion_push(&first);
+  motion_push(&second);
+  motion_poll(0);
+
+  for (i=0;i<4;i++) {
+    _step();
+    motion_poll(0);
+    TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[0]) == 5);
+  }
+
+  _step();
+  motion_poll(0);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[0]) == 2);
+  TEST_ASSERT(stepper_getDir(stepper_handles[0]) == STEPPER_DIR_REVERSE);
+
+  for (i=0;i<3;i++) {
+    _step();
+  }
+  motion_poll(0);
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 2);
+  TEST_ASSERT(motion_isIdle() == 1);
+}
+
+void test_poll_applies_speed_only_when_given(void)
+{
+  motion_cmd_t cmd = _move(0x01, 5, 0);
+
+  stepper_setSpeed(stepper_handles[0], 40);
+  motion_push(&cmd);
+  motion_poll(0);
+  TEST_ASSERT(stepper_getSpeed(stepper_handles[0]) == 40);
+
+  motion_init(stepper_handles, MAX_STEPPERS);
+  cmd.speed = 90;
+  motion_push(&cmd);
+  motion_poll(0);
+  TEST_ASSERT(stepper_getSpeed(stepper_handles[0]) == 90);
+}
+
+void test_poll_dwells_across_timer_wrap(void)
+{
+  motion_cmd_t cmd = _move(0, 0, 0);
+
+  cmd.op = MOTION_OP_DWELL;
+  cmd.dwell_ms = 100;
+  motion_push(&cmd);
+
+  motion_poll(65500);
+  TEST_ASSERT(motion_isIdle() == 0);
+  motion_poll(63);
+  TEST_ASSERT(motion_isIdle() == 0);
+  motion_poll(64);
+  TEST_ASSERT(motion_isIdle() == 1);
+}
+
+void test_poll_enables_and_disables_axes(void)
+{
+  motion_cmd_t cmd = _move(0x02, 0, 0);
+
+  cmd.op = MOTION_OP_ENABLE;
+  motion_push(&cmd);
+  motion_poll(0);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[0]) == STEPPER_STATUS_DISABLED);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[1]) == STEPPER_STATUS_ENABLED);
+
+  cmd.op = MOTION_OP_DISABLE;
+  motion_push(&cmd);
+  motion_poll(0);
+  TEST_ASSERT(stepper_getStatus(stepper_handles[1]) == STEPPER_STATUS_DISABLED);
+  TEST_ASSERT(motion_isIdle() == 1);
+}
+
+void test_push_returns_err_when_arc_not_on_both_axes(void)
+{
+  motion_cmd_t cmd = _move(0x01, 10, 0);
+
+  cmd.op = MOTION_OP_ARC_CW;
+  TEST_ASSERT(motion_push(&cmd) == MOTION_ERR_AXIS_INVALID);
+}
+
+void test_tick_steps_an_arc_and_holds_the_queue_until_done(void)
+{
+  uint16_t ticks = 0;
+  motion_cmd_t cmd = _move(0x03, 60, 40);
+  motion_cmd_t next = _move(0x01, 0, 0);
+
+  stepper_enable(stepper_handles[0]);
+  stepper_enable(stepper_handles[1]);
+  stepper_seedPos(stepper_handles[0], 40);
+  stepper_seedPos(stepper_handles[1], 60);
+  // a quarter circle around (40, 40)
+  cmd.op = MOTION_OP_ARC_CW;
+  cmd.center[0] = 0;
+  cmd.center[1] = -20;
+  motion_push(&cmd);
+  motion_push(&next);
+
+  motion_poll(0);
+  while (stepper_getDesiredPos1(stepper_handles[0]) != 0 && ticks < 1000) {
+    motion_tick();
+    _step();
+    motion_poll(0);
+    ticks++;
+  }
+
+  // the next move only started once the arc was finished
+  TEST_ASSERT(stepper_getPos(stepper_handles[0]) == 60);
+  TEST_ASSERT(stepper_getPos(stepper_handles[1]) == 40);
+  TEST_ASSERT(ticks >= 20);
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+static motion_cmd_t _move(uint8_t axes, uint8_t x, uint8_t y) {
+  motion_cmd_t cmd;
+
+  cmd.op = MOTION_OP_MOVE;
+  cmd.axes = axes;
+  cmd.target[0] = x;
+  cmd.target[1] = y;
+  cmd.center[0] = 0;
+  cmd.center[1] = 0;
+  cmd.speed = 0;
+  cmd.dwell_ms = 0;
+
+  return cmd;
+}
+
+static void _step(void) {
+  uint8_t i;
+
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_stepEngage(stepper_handles[i]);
+    stepper_stepRelease(stepper_handles[i]);
+  }
+}
@@ -0,0 +1,199 @@
+#include "unity.h"
+#include "fake_eeprom.h"
+#include "stepper_fixture.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "persist.h"
+#include "stepper.h"
+#include "crc8.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPERS 2
+#define EEPROM_BASE 16
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static stepper_descriptor_t stepper_handle;
+
+static const persist_backend_t backend = {
+  fake_eeprom_read,
+  fake_eeprom_write,
+  EEPROM_BASE
+};
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _powerCycle(void);
+static void _moveTo(uint8_t pos);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  fake_eeprom_init();
+  persist_init(&backend);
+  stepper_fixture_make(&stepper_handle);
+}
+
+void tearDown(void)
+{
+  uint8_t i;
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_destruct(i);
+  }
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_restore_returns_err_when_nothing_saved(void)
+{
+  TEST_ASSERT(persist_restore(stepper_handle) == PERSIST_ERR_NOT_FOUND);
+  TEST_ASSERT(stepper_getPos(stepper_handle) == 0);
+}
+
+void test_restore_returns_err_when_handle_invalid(void)
+{
+  uint8_t invalid_handle = 3;
+
+  TEST_ASSERT(persist_restore(invalid_handle) == PERSIST_ERR_HANDLE_INVALID);
+  TEST_ASSERT(persist_save(invalid_handle) == PERSIST_ERR_HANDLE_INVALID);
+}
+
+void test_restore_reseeds_position_and_step_size_after_power_cycle(void)
+{
+  _moveTo(42);
+  stepper_setStepSize(stepper_handle, STEPPER_STEP_SIZE_EIGHTH);
+  TEST_ASSERT(persist_save(stepper_handle) == PERSIST_ERR_NONE);
+
+  _powerCycle();
+
+  TEST_ASSERT(persist_restore(stepper_handle) == PERSIST_ERR_NONE);
+  TEST_ASSERT(stepper_getPos(stepper_handle) == 42);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handle) == 42);
+  TEST_ASSERT(stepper_getStepSize(stepper_handle) == STEPPER_STEP_SIZE_EIGHTH);
+}
+
+void test_restore_finds_newest_record_after_sequence_wraps(void)
+{
+  uint16_t i;
+
+  for (i=0;i<300;i++) {
+    _moveTo((uint8_t)(i % 150));
+    persist_save(stepper_handle);
+  }
+  _powerCycle();
+
+  persist_restore(stepper_handle);
+  TEST_ASSERT(stepper_getPos(stepper_handle) == 299 % 150);
+}
+
+void test_save_spreads_writes_over_the_ring(void)
+{
+  uint16_t i;
+  uint16_t saves = 10 * PERSIST_SLOTS;
+
+  for (i=0;i<saves;i++) {
+    _moveTo((uint8_t)(i % 100));
+    persist_save(stepper_handle);
+  }
+
+  for (i=0;i<PERSIST_SLOTS * PERSIST_SLOT_SIZE;i++) {
+    TEST_ASSERT(fake_eeprom_getWrites(EEPROM_BASE + i) == 10);
+  }
+}
+
+void test_init_continues_ring_after_power_cycle(void)
+{
+  _moveTo(5);
+  persist_save(stepper_handle);
+  _powerCycle();
+
+  _moveTo(6);
+  persist_save(stepper_handle);
+
+  TEST_ASSERT(fake_eeprom_getWrites(EEPROM_BASE) == 1);
+  TEST_ASSERT(fake_eeprom_getWrites(EEPROM_BASE + PERSIST_SLOT_SIZE) == 1);
+}
+
+void test_restore_ignores_record_torn_by_power_loss(void)
+{
+  _moveTo(20);
+  persist_save(stepper_handle);
+
+  _moveTo(30);
+  fake_eeprom_failAfter(2);
+  persist_save(stepper_handle);
+  _powerCycle();
+
+  persist_restore(stepper_handle);
+  TEST_ASSERT(stepper_getPos(stepper_handle) == 20);
+}
+
+void test_save_reports_worn_slot_and_moves_past_it(void)
+{
+  _moveTo(20);
+  fake_eeprom_stuck(EEPROM_BASE + 1);
+  TEST_ASSERT(persist_save(stepper_handle) == PERSIST_ERR_WRITE_FAILED);
+
+  TEST_ASSERT(persist_save(stepper_handle) == PERSIST_ERR_NONE);
+  _powerCycle();
+
+  persist_restore(stepper_handle);
+  TEST_ASSERT(stepper_getPos(stepper_handle) == 20);
+}
+
+void test_poll_saves_when_axis_disabled(void)
+{
+  stepper_disable(stepper_handle);
+
+  persist_poll();
+
+  TEST_ASSERT(fake_eeprom_getWrites(EEPROM_BASE) == 1);
+}
+
+void test_poll_doesnt_save_while_moving(void)
+{
+  stepper_enable(stepper_handle);
+  stepper_setPos(stepper_handle, 10, 0);
+  stepper_stepEngage(stepper_handle);
+  stepper_stepRelease(stepper_handle);
+
+  persist_poll();
+
+  TEST_ASSERT(fake_eeprom_getWrites(EEPROM_BASE) == 0);
+}
+
+void test_poll_saves_once_per_change(void)
+{
+  _moveTo(10);
+  persist_poll();
+  persist_poll();
+
+  TEST_ASSERT(fake_eeprom_getWrites(EEPROM_BASE) == 1);
+  TEST_ASSERT(fake_eeprom_getWrites(EEPROM_BASE + PERSIST_SLOT_SIZE) == 0);
+
+  _moveTo(11);
+  persist_poll();
+  TEST_ASSERT(fake_eeprom_getWrites(EEPROM_BASE + PERSIST_SLOT_SIZE) == 1);
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+// the eeprom keeps its contents, everything else starts over
+static void _powerCycle(void) {
+  tearDown();
+  stepper_fixture_make(&stepper_handle);
+  persist_init(&backend);
+}
+
+static void _moveTo(uint8_t pos) {
+  stepper_seedPos(stepper_handle, pos);
+}
@@ -0,0 +1,79 @@
+#include "unity.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "ringbuf.h"
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static ringbuf_t buf;
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  ringbuf_init(&buf);
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_init_leaves_buffer_empty(void)
+{
+  uint8_t byte;
+
+  TEST_ASSERT(ringbuf_getCount(&buf) == 0);
+  TEST_ASSERT(ringbuf_getFree(&buf) == RINGBUF_SIZE);
+  TEST_ASSERT(ringbuf_get(&buf, &byte) == 0);
+}
+
+void test_get_returns_bytes_in_order(void)
+{
+  uint8_t byte;
+
+  ringbuf_put(&buf, 'G');
+  ringbuf_put(&buf, '1');
+
+  TEST_ASSERT(ringbuf_peek(&buf, &byte) == 1);
+  TEST_ASSERT(byte == 'G');
+  TEST_ASSERT(ringbuf_get(&buf, &byte) == 1);
+  TEST_ASSERT(byte == 'G');
+  TEST_ASSERT(ringbuf_get(&buf, &byte) == 1);
+  TEST_ASSERT(byte == '1');
+  TEST_ASSERT(ringbuf_getCount(&buf) == 0);
+}
+
+void test_put_drops_bytes_when_full(void)
+{
+  uint8_t i;
+
+  for (i=0;i<RINGBUF_SIZE;i++) {
+    TEST_ASSERT(ringbuf_put(&buf, i) == 1);
+  }
+
+  TEST_ASSERT(ringbuf_put(&buf, 0xAA) == 0);
+  TEST_ASSERT(ringbuf_getCount(&buf) == RINGBUF_SIZE);
+  TEST_ASSERT(ringbuf_getFree(&buf) == 0);
+}
+
+void test_get_keeps_order_across_index_wrap(void)
+{
+  uint16_t i;
+  uint8_t byte;
+
+  for (i=0;i<1000;i++) {
+    ringbuf_put(&buf, (uint8_t)i);
+    ringbuf_put(&buf, (uint8_t)(i + 1));
+    ringbuf_get(&buf, &byte);
+    TEST_ASSERT(byte == (uint8_t)i);
+    ringbuf_get(&buf, &byte);
+    TEST_ASSERT(byte == (uint8_t)(i + 1));
+  }
+  TEST_ASSERT(ringbuf_getCount(&buf) == 0);
+}
@@ -0,0 +1,251 @@
+#include "unity.h"
+#include "stepper_fixture.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "script.h"
+#include "stepper.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define MAX_STEPPERS 2
+#define MAX_TICKS 2000
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static stepper_descriptor_t stepper_handles[MAX_STEPPERS];
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _tick(void);
+static uint16_t _runUntilDone(stepper_descriptor_t handle);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  uint8_t i;
+
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_fixture_make(&stepper_handles[i]);
+    stepper_enable(stepper_handles[i]);
+    script_stop(stepper_handles[i]);
+  }
+}
+
+void tearDown(void)
+{
+  uint8_t i;
+  for (i=0;i<MAX_STEPPERS;i++) {
+    stepper_destruct(i);
+  }
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_start_returns_err_when_handle_invalid(void)
+{
+  const uint8_t program[] = {SCRIPT_OP_END};
+
+  TEST_ASSERT(script_start(2, program, 1) == SCRIPT_ERR_HANDLE_INVALID);
+  stepper_destruct(1);
+  TEST_ASSERT(script_start(1, program, 1) == SCRIPT_ERR_HANDLE_INVALID);
+  TEST_ASSERT(script_tick(1) == SCRIPT_ERR_HANDLE_INVALID);
+}
+
+void test_start_returns_err_when_program_invalid(void)
+{
+  const uint8_t unknown[] = {0x40};
+  const uint8_t truncated[] = {SCRIPT_OP_DWELL, 10};
+  const uint8_t position[] = {SCRIPT_OP_MOVE_TO, 200};
+  const uint8_t step_size[] = {SCRIPT_OP_STEP_SIZE, 5};
+  const uint8_t wait_self[] = {SCRIPT_OP_WAIT, 0};
+  const uint8_t too_far[] = {SCRIPT_OP_LOOP, 2, 3};
+  const uint8_t mid_op[] = {SCRIPT_OP_MOVE_BY, 1, SCRIPT_OP_LOOP, 2, 1};
+
+  TEST_ASSERT(script_start(0, unknown, 1) == SCRIPT_ERR_OPTION_INVALID);
+  TEST_ASSERT(script_start(0, truncated, 2) == SCRIPT_ERR_OPTION_INVALID);
+  TEST_ASSERT(script_start(0, position, 2) == SCRIPT_ERR_OPTION_INVALID);
+  TEST_ASSERT(script_start(0, step_size, 2) == SCRIPT_ERR_OPTION_INVALID);
+  TEST_ASSERT(script_start(0, wait_self, 2) == SCRIPT_ERR_OPTION_INVALID);
+  TEST_ASSERT(script_start(0, too_far, 3) == SCRIPT_ERR_OPTION_INVALID);
+  TEST_ASSERT(script_start(0, mid_op, 5) == SCRIPT_ERR_OPTION_INVALID);
+  TEST_ASSERT(script_getStatus(0) == SCRIPT_STATUS_IDLE);
+}
+
+void test_tick_moves_then_finishes(void)
+{
+  const uint8_t program[] = {
+    SCRIPT_OP_SPEED, 40,
+    SCRIPT_OP_STEP_SIZE, STEPPER_STEP_SIZE_EIGHTH,
+    SCRIPT_OP_MOVE_TO, 10,
+    SCRIPT_OP_MOVE_TO, 4,
+    SCRIPT_OP_END
+  };
+
+  TEST_ASSERT(script_start(0, program, sizeof(program)) == SCRIPT_ERR_NONE);
+  script_tick(0);
+  TEST_ASSERT(stepper_getSpeed(0) == 40);
+  TEST_ASSERT(stepper_getStepSize(0) == STEPPER_STEP_SIZE_EIGHTH);
+  TEST_ASSERT(stepper_getDesiredPos1(0) == 10);
+  TEST_ASSERT(stepper_getDir(0) == STEPPER_DIR_FORWARD);
+
+  // 10 steps out, 6 back, then the tick that sees it arrive
+  TEST_ASSERT(_runUntilDone(0) == 17);
+  TEST_ASSERT(stepper_getPos(0) == 4);
+  TEST_ASSERT(stepper_getDir(0) == STEPPER_DIR_REVERSE);
+}
+
+void test_tick_moves_by_wrap_around(void)
+{
+  const uint8_t program[] = {SCRIPT_OP_MOVE_BY, (uint8_t)-3};
+
+  script_start(0, program, sizeof(program));
+  _runUntilDone(0);
+
+  TEST_ASSERT(stepper_getPos(0) == 197);
+  TEST_ASSERT(stepper_getDir(0) == STEPPER_DIR_REVERSE);
+}
+
+void test_tick_dwells_for_given_ticks(void)
+{
+  const uint8_t program[] = {
+    SCRIPT_OP_DWELL, 0x2c, 0x01,
+    SCRIPT_OP_MOVE_TO, 1
+  };
+
+  script_start(0, program, sizeof(program));
+
+  // 300 ticks after the dwell starts the move goes out, one more to arrive
+  TEST_ASSERT(_runUntilDone(0) == 302);
+  TEST_ASSERT(stepper_getPos(0) == 1);
+}
+
+void test_tick_repeats_loop_body(void)
+{
+  const uint8_t program[] = {
+    SCRIPT_OP_MOVE_BY, 2,
+    SCRIPT_OP_MOVE_BY, 3,
+    SCRIPT_OP_LOOP, 2, 2,
+    SCRIPT_OP_LOOP, 3, 7
+  };
+
+  script_start(0, program, sizeof(program));
+  _runUntilDone(0);
+
+  // (2 + 3 + 3) three times over
+  TEST_ASSERT(stepper_getPos(0) == 24);
+}
+
+void test_tick_limits_instructions_per_tick(void)
+{
+  const uint8_t program[] = {
+    SCRIPT_OP_SPEED, 1,
+    SCRIPT_OP_LOOP, 0, 2
+  };
+  uint8_t i;
+
+  script_start(0, program, sizeof(program));
+  for (i=0;i<100;i++) {
+    script_tick(0);
+  }
+
+  TEST_ASSERT(script_getStatus(0) == SCRIPT_STATUS_RUNNING);
+  script_stop(0);
+  TEST_ASSERT(script_getStatus(0) == SCRIPT_STATUS_IDLE);
+}
+
+void test_tick_faults_when_loops_nest_too_deep(void)
+{
+  const uint8_t program[] = {
+    SCRIPT_OP_SPEED, 1,
+    SCRIPT_OP_SPEED, 2,
+    SCRIPT_OP_SPEED, 3,
+    SCRIPT_OP_LOOP, 2, 2,
+    SCRIPT_OP_LOOP, 2, 7,
+    SCRIPT_OP_LOOP, 2, 12
+  };
+  uint8_t i;
+
+  script_start(0, program, sizeof(program));
+  for (i=0;i<20;i++) {
+    script_tick(0);
+  }
+
+  TEST_ASSERT(script_getStatus(0) == SCRIPT_STATUS_FAULT);
+}
+
+void test_tick_wait_holds_axes_together(void)
+{
+  const uint8_t short_move[] = {
+    SCRIPT_OP_MOVE_TO, 5,
+    SCRIPT_OP_WAIT, 1,
+    SCRIPT_OP_MOVE_TO, 6
+  };
+  const uint8_t long_move[] = {
+    SCRIPT_OP_MOVE_TO, 50,
+    SCRIPT_OP_WAIT, 0,
+    SCRIPT_OP_MOVE_TO, 51
+  };
+  uint8_t i;
+
+  script_start(0, short_move, sizeof(short_move));
+  script_start(1, long_move, sizeof(long_move));
+
+  for (i=0;i<51;i++) {
+    _tick();
+  }
+  TEST_ASSERT(stepper_getPos(0) == 5);
+  TEST_ASSERT(stepper_getPos(1) == 50);
+
+  // both are released on the same tick
+  _tick();
+  TEST_ASSERT(stepper_getPos(0) == 6);
+  TEST_ASSERT(stepper_getPos(1) == 51);
+}
+
+void test_tick_wait_passes_when_other_axis_has_no_script(void)
+{
+  const uint8_t program[] = {
+    SCRIPT_OP_WAIT, 1,
+    SCRIPT_OP_MOVE_TO, 3
+  };
+
+  stepper_setPos(1, 8, 0);
+  script_start(0, program, sizeof(program));
+
+  TEST_ASSERT(_runUntilDone(0) == 12);
+  TEST_ASSERT(stepper_getPos(1) == 8);
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+// what the step timer isr does each tick
+static void _tick(void) {
+  uint8_t i;
+
+  for (i=0;i<MAX_STEPPERS;i++) {
+    script_tick(stepper_handles[i]);
+    stepper_stepEngage(stepper_handles[i]);
+    stepper_stepRelease(stepper_handles[i]);
+  }
+}
+
+static uint16_t _runUntilDone(stepper_descriptor_t handle) {
+  uint16_t ticks = 0;
+
+  while (script_getStatus(handle) == SCRIPT_STATUS_RUNNING
+    && ticks < MAX_TICKS
+  ) {
+    _tick();
+    ticks++;
+  }
+
+  return ticks;
+}
@@ -0,0 +1,294 @@
+#include "unity.h"
+#include <stdlib.h>
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "scurve.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define TICK_HZ 1000000UL
+#define MIN_SPEED 100
+#define MAX_SPEED 5000
+#define MAX_ACCEL 50000UL
+#define MAX_JERK 2000000UL
+#define MAX_STEPS 4000
+// steps averaged together when estimating speed from the interval stream
+#define WINDOW 16
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static scurve_t profile;
+static scurve_attr_t config;
+static uint16_t intervals[MAX_STEPS];
+static uint16_t num_intervals;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static void _generate(uint16_t steps);
+static void _assertWithinLimits(uint16_t steps);
+static int32_t _windowSpeed(uint16_t start);
+static uint32_t _windowTicks(uint16_t start);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  config.tick_hz = TICK_HZ;
+  config.min_speed = MIN_SPEED;
+  config.max_speed = MAX_SPEED;
+  config.max_accel = MAX_ACCEL;
+  config.max_jerk = MAX_JERK;
+  num_intervals = 0;
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_plan_returns_error_when_config_invalid(void)
+{
+  config.max_speed = MIN_SPEED - 1;
+  TEST_ASSERT(scurve_plan(&profile, config, 100) == SCURVE_ERR_OPTION_INVALID);
+
+  setUp();
+  config.max_jerk = 0;
+  TEST_ASSERT(scurve_plan(&profile, config, 100) == SCURVE_ERR_OPTION_INVALID);
+
+  setUp();
+  config.tick_hz = 0;
+  TEST_ASSERT(scurve_plan(&profile, config, 100) == SCURVE_ERR_OPTION_INVALID);
+}
+
+void test_plan_returns_error_when_slowest_interval_overflows(void)
+{
+  // a min_speed step would be 160000 ticks
+  config.tick_hz = 16000000UL;
+  TEST_ASSERT(scurve_plan(&profile, config, 100) == SCURVE_ERR_OPTION_INVALID);
+}
+
+void test_plan_returns_error_when_accel_overflows_a_step(void)
+{
+  config.max_accel = 4000000UL;
+  TEST_ASSERT(scurve_plan(&profile, config, 100) == SCURVE_ERR_OPTION_INVALID);
+
+  setUp();
+  config.tick_hz = 20000;
+  config.max_accel = 1000000UL;
+  config.max_jerk = 100000000UL;
+  TEST_ASSERT(scurve_plan(&profile, config, 100) == SCURVE_ERR_OPTION_INVALID);
+}
+
+void test_plan_returns_error_when_jerk_segment_shorter_than_a_step(void)
+{
+  // a 10 tick jerk segment against 1000 tick steps at min_speed
+  config.tick_hz = 20000;
+  config.min_speed = 20;
+  config.max_speed = 2000;
+  config.max_accel = 200000UL;
+  config.max_jerk = 20000000UL;
+  TEST_ASSERT(scurve_plan(&profile, config, 1000) == SCURVE_ERR_OPTION_INVALID);
+}
+
+void test_plan_returns_success_when_config_valid(void)
+{
+  TEST_ASSERT(scurve_plan(&profile, config, 100) == SCURVE_ERR_NONE);
+  TEST_ASSERT(scurve_getStepsLeft(&profile) == 100);
+}
+
+void test_nextInterval_issues_exactly_the_planned_steps(void)
+{
+  _generate(MAX_STEPS);
+
+  TEST_ASSERT(num_intervals == MAX_STEPS);
+  TEST_ASSERT(scurve_getStepsLeft(&profile) == 0);
+  TEST_ASSERT(scurve_nextInterval(&profile) == 0);
+}
+
+void test_nextInterval_starts_and_ends_at_min_speed(void)
+{
+  uint32_t min_interval = TICK_HZ / MIN_SPEED;
+
+  _generate(MAX_STEPS);
+
+  // the first step is timed from the speed half way through it
+  TEST_ASSERT(intervals[0] >= min_interval * 3 / 4);
+  TEST_ASSERT(intervals[0] <= min_interval);
+  // the move ends on a whole step so the last one can land a little before
+  // the profile has fully decelerated
+  TEST_ASSERT(intervals[num_intervals - 1] >= min_interval / 2);
+  TEST_ASSERT(intervals[num_intervals - 1] <= min_interval);
+}
+
+void test_nextInterval_cruises_at_max_speed_on_long_moves(void)
+{
+  _generate(MAX_STEPS);
+
+  TEST_ASSERT_INT32_WITHIN(
+    MAX_SPEED / 100,
+    MAX_SPEED,
+    _windowSpeed(MAX_STEPS / 2)
+  );
+}
+
+void test_nextInterval_limits_peak_speed_on_short_moves(void)
+{
+  uint16_t i;
+  int32_t peak = 0;
+
+  _generate(200);
+
+  for (i=0;i + WINDOW<=num_intervals;i++) {
+    if (_windowSpeed(i) > peak) {
+      peak = _windowSpeed(i);
+    }
+  }
+  TEST_ASSERT(num_intervals == 200);
+  TEST_ASSERT(peak > MIN_SPEED);
+  TEST_ASSERT(peak < MAX_SPEED);
+}
+
+void test_nextInterval_speed_is_continuous(void)
+{
+  uint16_t i;
+  uint16_t interval;
+  int32_t dv;
+  int32_t max_dv;
+
+  _generate(MAX_STEPS);
+
+  for (i=0;i + 1 + WINDOW<=num_intervals;i++) {
+    dv = abs(_windowSpeed(i + 1) - _windowSpeed(i));
+    // sliding the window by a step can only change the speed by what
+    // max_accel allows over the longer of the two steps, plus rounding
+    interval = intervals[i];
+    if (intervals[i + WINDOW] > interval) {
+      interval = intervals[i + WINDOW];
+    }
+    max_dv = (int32_t)((MAX_ACCEL * interval) / TICK_HZ) + 2;
+    TEST_ASSERT(dv <= max_dv);
+  }
+}
+
+void test_nextInterval_acceleration_is_continuous(void)
+{
+  uint16_t i;
+  uint32_t dt;
+  int32_t a;
+  int32_t prev_a = 0;
+  int32_t max_da;
+
+  _generate(MAX_STEPS);
+
+  for (i=0;i + 2 * WINDOW<=num_intervals;i+=WINDOW) {
+    // the window speeds are measured at their centres, half a window each
+    dt = (_windowTicks(i) + _windowTicks(i + WINDOW)) / 2;
+    a = (int32_t)(
+      ((int64_t)(_windowSpeed(i + WINDOW) - _windowSpeed(i)) * (int64_t)TICK_HZ)
+      / (int64_t)dt
+    );
+    TEST_ASSERT(abs(a) <= (int32_t)(MAX_ACCEL + MAX_ACCEL / 20));
+    // a trapezoid would jump by max_accel here, jerk limiting keeps the change
+    // between neighbouring windows to what max_jerk allows plus rounding
+    max_da = (int32_t)((MAX_JERK * 2 * dt) / TICK_HZ)
+      + (int32_t)(MAX_ACCEL / 10);
+    TEST_ASSERT(abs(a - prev_a) <= max_da);
+    prev_a = a;
+  }
+}
+
+void test_nextInterval_holds_limits_at_low_tick_rates(void)
+{
+  // long jerk segments against few ticks per step, on long and short moves
+  config.tick_hz = 20000;
+  config.min_speed = 50;
+  config.max_speed = 3000;
+  config.max_accel = 50000UL;
+  config.max_jerk = 1000000UL;
+  _assertWithinLimits(2000);
+  _assertWithinLimits(1000);
+  _assertWithinLimits(30);
+
+  config.tick_hz = 50000;
+  config.min_speed = 200;
+  config.max_speed = 6000;
+  config.max_accel = 400000UL;
+  config.max_jerk = 40000000UL;
+  _assertWithinLimits(2000);
+  _assertWithinLimits(200);
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+// plans a move of steps with config and checks that it starts and ends at
+// min_speed, never passes max_speed, and that no step changes the speed by
+// more than max_accel allows over it plus a tick of rounding either side
+static void _assertWithinLimits(uint16_t steps) {
+  uint32_t min_interval = config.tick_hz / config.min_speed;
+  uint16_t i;
+  uint32_t shorter;
+  uint32_t longer;
+  int32_t dv;
+  int32_t max_dv;
+
+  TEST_ASSERT(scurve_plan(&profile, config, steps) == SCURVE_ERR_NONE);
+  _generate(steps);
+  TEST_ASSERT(num_intervals == steps);
+  TEST_ASSERT(intervals[0] >= min_interval * 3 / 4);
+  TEST_ASSERT(intervals[0] <= min_interval);
+  TEST_ASSERT(intervals[num_intervals - 1] >= min_interval * 3 / 4);
+  TEST_ASSERT(intervals[num_intervals - 1] <= min_interval);
+
+  for (i=0;i<num_intervals;i++) {
+    TEST_ASSERT(intervals[i] >= config.tick_hz / config.max_speed);
+  }
+
+  for (i=0;i + 1<num_intervals;i++) {
+    shorter = intervals[i];
+    longer = intervals[i + 1];
+    if (shorter > longer) {
+      shorter = intervals[i + 1];
+      longer = intervals[i];
+    }
+    dv = (int32_t)(config.tick_hz / shorter - config.tick_hz / longer);
+    max_dv = (int32_t)((config.max_accel * longer) / config.tick_hz)
+      + (int32_t)(config.tick_hz / (shorter - 1))
+      - (int32_t)(config.tick_hz / (shorter + 1));
+    TEST_ASSERT(dv <= max_dv);
+  }
+}
+
+static void _generate(uint16_t steps) {
+  uint16_t interval;
+
+  scurve_plan(&profile, config, steps);
+  num_intervals = 0;
+  interval = scurve_nextInterval(&profile);
+  while (interval != 0 && num_intervals < MAX_STEPS) {
+    intervals[num_intervals++] = interval;
+    interval = scurve_nextInterval(&profile);
+  }
+}
+
+static uint32_t _windowTicks(uint16_t start) {
+  uint16_t i;
+  uint32_t ticks = 0;
+
+  for (i=start;i<start + WINDOW;i++) {
+    ticks += intervals[i];
+  }
+
+  return ticks;
+}
+
+static int32_t _windowSpeed(uint16_t start) {
+  return (int32_t)((WINDOW * TICK_HZ) / _windowTicks(start));
+}
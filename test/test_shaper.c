@@ -0,0 +1,233 @@
+#include "unity.h"
+#include "resonance.h"
+#include "stepper_fixture.h"
+/*******************************************************************************
+* Module Under Test
+*******************************************************************************/
+#include "shaper.h"
+#include "stepper.h"
+
+/*******************************************************************************
+* Private Defines
+*******************************************************************************/
+#define TICK_HZ 10000UL
+#define FREQ_DHZ 200
+#define DAMPING_PM 50
+#define MOVE_STEPS 200
+#define MOVE_INTERVAL 10
+#define SETTLE_TICKS 5000
+
+/*******************************************************************************
+* Local Data
+*******************************************************************************/
+static shaper_t shaper;
+static shaper_attr_t config;
+static stepper_descriptor_t handle;
+
+/*******************************************************************************
+* Private Function Declarations
+*******************************************************************************/
+static double _residual(shaper_type_t type, uint16_t plant_freq_dhz);
+
+/*******************************************************************************
+* Setup and Teardown
+*******************************************************************************/
+void setUp(void)
+{
+  config.type = SHAPER_TYPE_ZV;
+  config.tick_hz = TICK_HZ;
+  config.freq_dhz = FREQ_DHZ;
+  config.damping_pm = DAMPING_PM;
+  stepper_fixture_make(&handle);
+  stepper_enable(handle);
+}
+
+void tearDown(void)
+{
+  stepper_destruct(handle);
+}
+
+/*******************************************************************************
+* Tests
+*******************************************************************************/
+void test_init_returns_error_when_config_invalid(void)
+{
+  config.damping_pm = 1000;
+  TEST_ASSERT(shaper_init(&shaper, config) == SHAPER_ERR_OPTION_INVALID);
+
+  setUp();
+  config.freq_dhz = 0;
+  TEST_ASSERT(shaper_init(&shaper, config) == SHAPER_ERR_OPTION_INVALID);
+
+  setUp();
+  config.type = (shaper_type_t)7;
+  TEST_ASSERT(shaper_init(&shaper, config) == SHAPER_ERR_OPTION_INVALID);
+}
+
+void test_init_returns_error_when_period_too_long(void)
+{
+  config.type = SHAPER_TYPE_ZVD;
+  config.tick_hz = 1000000UL;
+  config.freq_dhz = 10;
+
+  TEST_ASSERT(shaper_init(&shaper, config) == SHAPER_ERR_OPTION_INVALID);
+}
+
+void test_init_places_zv_impulse_half_a_damped_period_later(void)
+{
+  TEST_ASSERT(shaper_init(&shaper, config) == SHAPER_ERR_NONE);
+
+  TEST_ASSERT(shaper.num_impulses == 2);
+  TEST_ASSERT(shaper.delay[0] == 0);
+  TEST_ASSERT_UINT16_WITHIN(1, 250, shaper.delay[1]);
+  // K = exp(-0.05 * pi / sqrt(1 - 0.05^2)) = 0.8546 so A1 = 1 / (1 + K)
+  TEST_ASSERT_UINT16_WITHIN(20, 17674, shaper.amplitude[0]);
+  TEST_ASSERT(shaper.amplitude[0] + shaper.amplitude[1] == 32768);
+}
+
+void test_init_places_zvd_impulses_over_a_damped_period(void)
+{
+  config.type = SHAPER_TYPE_ZVD;
+  TEST_ASSERT(shaper_init(&shaper, config) == SHAPER_ERR_NONE);
+
+  TEST_ASSERT(shaper.num_impulses == 3);
+  TEST_ASSERT_UINT16_WITHIN(1, 250, shaper.delay[1]);
+  TEST_ASSERT_UINT16_WITHIN(1, 501, shaper.delay[2]);
+  TEST_ASSERT(
+    shaper.amplitude[0] + shaper.amplitude[1] + shaper.amplitude[2] == 32768
+  );
+}
+
+void test_tick_passes_steps_straight_through_without_shaping(void)
+{
+  config.type = SHAPER_TYPE_NONE;
+  shaper_init(&shaper, config);
+
+  shaper_push(&shaper, 1);
+  TEST_ASSERT(shaper_tick(&shaper) == 1);
+  TEST_ASSERT(shaper_tick(&shaper) == 0);
+  shaper_push(&shaper, -1);
+  TEST_ASSERT(shaper_tick(&shaper) == -1);
+}
+
+void test_tick_releases_every_pushed_step(void)
+{
+  uint16_t i;
+  int16_t emitted = 0;
+
+  config.type = SHAPER_TYPE_ZVD;
+  shaper_init(&shaper, config);
+
+  for (i=0;i<MOVE_STEPS * MOVE_INTERVAL;i++) {
+    if (i % MOVE_INTERVAL == 0) {
+      shaper_push(&shaper, 1);
+    }
+    emitted += shaper_tick(&shaper);
+  }
+  TEST_ASSERT(shaper_getLag(&shaper) > 0);
+
+  for (i=0;i<SETTLE_TICKS;i++) {
+    emitted += shaper_tick(&shaper);
+  }
+  TEST_ASSERT(shaper_getLag(&shaper) == 0);
+  TEST_ASSERT(emitted == MOVE_STEPS);
+}
+
+void test_tickStepper_moves_the_motor_through_every_shaped_step(void)
+{
+  uint16_t i;
+  uint16_t moved = 0;
+  uint8_t pos;
+
+  config.type = SHAPER_TYPE_ZVD;
+  shaper_init(&shaper, config);
+
+  for (i=0;i<MOVE_STEPS * MOVE_INTERVAL + SETTLE_TICKS;i++) {
+    if (i < MOVE_STEPS * MOVE_INTERVAL && i % MOVE_INTERVAL == 0) {
+      shaper_push(&shaper, -1);
+    }
+    TEST_ASSERT(shaper_tickStepper(&shaper, handle) == SHAPER_ERR_NONE);
+    pos = stepper_getPos(handle);
+    stepper_stepEngage(handle);
+    stepper_stepRelease(handle);
+    if (stepper_getPos(handle) != pos) {
+      moved++;
+    }
+  }
+
+  TEST_ASSERT(shaper_getLag(&shaper) == 0);
+  // MOVE_STEPS is a whole revolution backwards
+  TEST_ASSERT(moved == MOVE_STEPS);
+  TEST_ASSERT(stepper_getPos(handle) == 0);
+  TEST_ASSERT(stepper_getDir(handle) == STEPPER_DIR_REVERSE);
+}
+
+void test_tickStepper_returns_error_when_handle_invalid(void)
+{
+  shaper_init(&shaper, config);
+  shaper_push(&shaper, 1);
+  stepper_destruct(handle);
+
+  TEST_ASSERT(
+    shaper_tickStepper(&shaper, handle) == SHAPER_ERR_HANDLE_INVALID
+  );
+}
+
+void test_tick_zv_reduces_residual_vibration(void)
+{
+  double unshaped = _residual(SHAPER_TYPE_NONE, FREQ_DHZ);
+  double shaped = _residual(SHAPER_TYPE_ZV, FREQ_DHZ);
+
+  TEST_ASSERT(unshaped > 2.0);
+  TEST_ASSERT(shaped < unshaped / 5);
+}
+
+void test_tick_zvd_reduces_residual_vibration_when_resonance_is_off(void)
+{
+  double unshaped = _residual(SHAPER_TYPE_NONE, FREQ_DHZ * 11 / 10);
+  double zv = _residual(SHAPER_TYPE_ZV, FREQ_DHZ * 11 / 10);
+  double zvd = _residual(SHAPER_TYPE_ZVD, FREQ_DHZ * 11 / 10);
+
+  TEST_ASSERT(zv < unshaped);
+  TEST_ASSERT(zvd < zv);
+  TEST_ASSERT(zvd < unshaped / 5);
+}
+
+/*******************************************************************************
+* Private Function Definitions
+*******************************************************************************/
+// runs a constant speed move with abrupt start and stop through the shaper
+// into a resonant load and returns the peak oscillation once the motor stops
+static double _residual(shaper_type_t type, uint16_t plant_freq_dhz) {
+  resonance_t model;
+  uint32_t i;
+  double error;
+  double peak = 0;
+
+  config.type = type;
+  shaper_init(&shaper, config);
+  resonance_init(&model, plant_freq_dhz, DAMPING_PM, TICK_HZ);
+
+  for (i=0;i<MOVE_STEPS * MOVE_INTERVAL;i++) {
+    if (i % MOVE_INTERVAL == 0) {
+      shaper_push(&shaper, 1);
+    }
+    resonance_tick(&model, shaper_tick(&shaper));
+  }
+  while (shaper_getLag(&shaper) != 0) {
+    resonance_tick(&model, shaper_tick(&shaper));
+  }
+
+  for (i=0;i<SETTLE_TICKS;i++) {
+    resonance_tick(&model, shaper_tick(&shaper));
+    error = resonance_getError(&model);
+    if (error < 0) {
+      error = -error;
+    }
+    if (error > peak) {
+      peak = error;
+    }
+  }
+
+  return peak;
+}
@@ -43,6 +43,8 @@ stepper_descriptor_t stepper_handles[2];
 * Private Function Declarations
 *******************************************************************************/
 stepper_err_t _makeStepper(uint8_t handle_index);
+static void _makeOscillator(uint8_t handle_index);
+static uint8_t _ticksToNextStep(stepper_descriptor_t handle);
 
 /*******************************************************************************
 * Setup and Teardown
@@ -596,6 +598,620 @@ void test_stepRelease_swaps_desired_positions_and_direction(void)
   );
 }
 
+void test_getStepsRemaining_counts_forward_to_desired_position(void)
+{
+  uint8_t handle_index = 0;
+
+  _makeStepper(handle_index);
+  stepper_setPos(stepper_handles[handle_index], 10, 0);
+
+  TEST_ASSERT(stepper_getStepsRemaining(stepper_handles[handle_index]) == 10);
+}
+
+void test_getStepsRemaining_wraps_in_reverse_direction(void)
+{
+  uint8_t handle_index = 0;
+
+  _makeStepper(handle_index);
+  stepper_setPos(stepper_handles[handle_index], 10, 0);
+  stepper_setDir(stepper_handles[handle_index], STEPPER_DIR_REVERSE);
+
+  TEST_ASSERT(
+    stepper_getStepsRemaining(stepper_handles[handle_index])
+    == (MAX_STEPPER_POS + 1 - 10)
+  );
+}
+
+void test_setBacklash_sets_backlash(void)
+{
+  uint8_t handle_index = 0;
+  _makeStepper(handle_index);
+
+  TEST_ASSERT(
+    stepper_setBacklash(stepper_handles[handle_index], 3)
+    == STEPPER_ERR_NONE
+  );
+  TEST_ASSERT(stepper_getBacklash(stepper_handles[handle_index]) == 3);
+}
+
+void test_setBacklash_returns_error_when_handle_invalid(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t invalid_handle = 3;
+  _makeStepper(handle_index);
+
+  TEST_ASSERT(
+    stepper_setBacklash(invalid_handle, 3)
+    == STEPPER_ERR_HANDLE_INVALID
+  );
+}
+
+void test_stepEngage_inserts_backlash_steps_after_reversal(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t i;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setBacklash(stepper_handles[handle_index], 3);
+  stepper_setPos(stepper_handles[handle_index], 2, 0);
+  stepper_stepEngage(stepper_handles[handle_index]);
+  stepper_stepRelease(stepper_handles[handle_index]);
+
+  stepper_setDir(stepper_handles[handle_index], STEPPER_DIR_REVERSE);
+  stepper_setPos(stepper_handles[handle_index], 0, 0);
+  TEST_ASSERT(stepper_getBacklashPending(stepper_handles[handle_index]) == 3);
+  for (i=0;i<3;i++) {
+    stepper_stepEngage(stepper_handles[handle_index]);
+    TEST_ASSERT(step_port & (1 << step_pin));
+    TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 1);
+    stepper_stepRelease(stepper_handles[handle_index]);
+  }
+
+  stepper_stepEngage(stepper_handles[handle_index]);
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 0);
+  TEST_ASSERT(stepper_getBacklashPending(stepper_handles[handle_index]) == 0);
+}
+
+void test_setDir_doesnt_insert_backlash_without_reversal(void)
+{
+  uint8_t handle_index = 0;
+
+  _makeStepper(handle_index);
+  stepper_setBacklash(stepper_handles[handle_index], 3);
+  stepper_setDir(stepper_handles[handle_index], STEPPER_DIR_FORWARD);
+
+  TEST_ASSERT(stepper_getBacklashPending(stepper_handles[handle_index]) == 0);
+}
+
+void test_setDir_reversing_mid_compensation_keeps_slack_taken_up(void)
+{
+  uint8_t handle_index = 0;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setBacklash(stepper_handles[handle_index], 3);
+  stepper_setPos(stepper_handles[handle_index], 5, 0);
+  stepper_setDir(stepper_handles[handle_index], STEPPER_DIR_REVERSE);
+  stepper_stepEngage(stepper_handles[handle_index]);
+  stepper_stepRelease(stepper_handles[handle_index]);
+
+  stepper_setDir(stepper_handles[handle_index], STEPPER_DIR_FORWARD);
+
+  TEST_ASSERT(stepper_getBacklashPending(stepper_handles[handle_index]) == 1);
+}
+
+void test_stepRelease_oscillate_turnaround_inserts_backlash(void)
+{
+  uint8_t handle_index = 0;
+
+  _makeStepper(handle_index);
+  stepper_setMode(stepper_handles[handle_index], STEPPER_MODE_OSCILLATE);
+  stepper_setBacklash(stepper_handles[handle_index], 2);
+  stepper_setPos(stepper_handles[handle_index], 1, 0);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_stepEngage(stepper_handles[handle_index]);
+
+  stepper_stepRelease(stepper_handles[handle_index]);
+
+  TEST_ASSERT(dir_port & (1 << dir_pin));
+  TEST_ASSERT(stepper_getBacklashPending(stepper_handles[handle_index]) == 2);
+  stepper_stepEngage(stepper_handles[handle_index]);
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 1);
+}
+
+void test_stepEngage_issues_correction_steps_without_moving_position(void)
+{
+  uint8_t handle_index = 0;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setCorrection(stepper_handles[handle_index], 1);
+
+  stepper_stepEngage(stepper_handles[handle_index]);
+
+  TEST_ASSERT(step_port & (1 << step_pin));
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 0);
+  TEST_ASSERT(stepper_getCorrectionPending(stepper_handles[handle_index]) == 0);
+}
+
+void test_setCorrection_returns_error_when_handle_invalid(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t invalid_handle = 3;
+  _makeStepper(handle_index);
+
+  TEST_ASSERT(
+    stepper_setCorrection(invalid_handle, 1)
+    == STEPPER_ERR_HANDLE_INVALID
+  );
+}
+
+void test_seedPos_sets_position_without_stepping(void)
+{
+  uint8_t handle_index = 0;
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+
+  TEST_ASSERT(
+    stepper_seedPos(stepper_handles[handle_index], 120)
+    == STEPPER_ERR_NONE
+  );
+  stepper_stepEngage(stepper_handles[handle_index]);
+
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 120);
+  TEST_ASSERT((step_port & (1 << step_pin)) == 0);
+}
+
+void test_seedPos_returns_error_when_position_invalid(void)
+{
+  uint8_t handle_index = 0;
+  _makeStepper(handle_index);
+
+  TEST_ASSERT(
+    stepper_seedPos(stepper_handles[handle_index], MAX_STEPPER_POS + 1)
+    == STEPPER_ERR_POSITION_INVALID
+  );
+}
+
+void test_move_moves_desired_position_and_sets_direction(void)
+{
+  uint8_t handle_index = 0;
+  _makeStepper(handle_index);
+  stepper_setPos(stepper_handles[handle_index], 10, 0);
+
+  TEST_ASSERT(
+    stepper_move(stepper_handles[handle_index], 5) == STEPPER_ERR_NONE
+  );
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[handle_index]) == 15);
+  TEST_ASSERT(
+    stepper_getDir(stepper_handles[handle_index]) == STEPPER_DIR_FORWARD
+  );
+
+  stepper_move(stepper_handles[handle_index], -7);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[handle_index]) == 8);
+  TEST_ASSERT(
+    stepper_getDir(stepper_handles[handle_index]) == STEPPER_DIR_REVERSE
+  );
+}
+
+void test_move_wraps_round_the_revolution(void)
+{
+  uint8_t handle_index = 0;
+  _makeStepper(handle_index);
+  stepper_setPos(stepper_handles[handle_index], MAX_STEPPER_POS, 0);
+
+  stepper_move(stepper_handles[handle_index], 1);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[handle_index]) == 0);
+
+  stepper_move(stepper_handles[handle_index], -3);
+  TEST_ASSERT(
+    stepper_getDesiredPos1(stepper_handles[handle_index])
+    == MAX_STEPPER_POS - 2
+  );
+}
+
+void test_move_returns_error_when_handle_invalid(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t invalid_handle = 3;
+  _makeStepper(handle_index);
+
+  TEST_ASSERT(stepper_move(invalid_handle, 1) == STEPPER_ERR_HANDLE_INVALID);
+}
+
+void test_setTurnaround_returns_error_when_handle_invalid(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t invalid_handle = 3;
+  _makeStepper(handle_index);
+
+  TEST_ASSERT(
+    stepper_setTurnaround(invalid_handle, 4, 0)
+    == STEPPER_ERR_HANDLE_INVALID
+  );
+}
+
+void test_stepEngage_oscillate_ramps_into_and_out_of_each_end(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t i;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setMode(stepper_handles[handle_index], STEPPER_MODE_OSCILLATE);
+  stepper_setTurnaround(stepper_handles[handle_index], 4, 0);
+  stepper_setPos(stepper_handles[handle_index], 20, 0);
+
+  // within 3 steps of either end a step takes 2 ticks, otherwise 1
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 1);
+  for (i=0;i<3;i++) {
+    TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 2);
+  }
+  for (i=0;i<13;i++) {
+    TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 1);
+  }
+  for (i=0;i<3;i++) {
+    TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 2);
+  }
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 20);
+
+  TEST_ASSERT(
+    stepper_getDir(stepper_handles[handle_index]) == STEPPER_DIR_REVERSE
+  );
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 2);
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 19);
+}
+
+void test_stepEngage_oscillate_dwells_at_each_end(void)
+{
+  uint8_t handle_index = 0;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setMode(stepper_handles[handle_index], STEPPER_MODE_OSCILLATE);
+  stepper_setTurnaround(stepper_handles[handle_index], 0, 5);
+  stepper_setPos(stepper_handles[handle_index], 2, 0);
+
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 1);
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 1);
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 6);
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 1);
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 1);
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 6);
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 1);
+}
+
+void test_setSequence_returns_error_when_position_invalid(void)
+{
+  uint8_t handle_index = 0;
+  stepper_pair_t pairs[] = {{10, 0}, {MAX_STEPPER_POS + 1, 0}};
+  _makeStepper(handle_index);
+
+  TEST_ASSERT(
+    stepper_setSequence(stepper_handles[handle_index], pairs, 2)
+    == STEPPER_ERR_POSITION_INVALID
+  );
+}
+
+void test_stepRelease_oscillate_runs_one_cycle_per_pair(void)
+{
+  uint8_t handle_index = 0;
+  stepper_pair_t pairs[] = {{10, 5}, {30, 0}};
+  uint8_t i;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setMode(stepper_handles[handle_index], STEPPER_MODE_OSCILLATE);
+  TEST_ASSERT(
+    stepper_setSequence(stepper_handles[handle_index], pairs, 2)
+    == STEPPER_ERR_NONE
+  );
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[handle_index]) == 10);
+  TEST_ASSERT(stepper_getSequenceIndex(stepper_handles[handle_index]) == 0);
+
+  // out 10, back 5, then on to the second pair
+  for (i=0;i<15;i++) {
+    _ticksToNextStep(stepper_handles[handle_index]);
+  }
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 5);
+  TEST_ASSERT(stepper_getSequenceIndex(stepper_handles[handle_index]) == 1);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[handle_index]) == 30);
+  TEST_ASSERT(
+    stepper_getDir(stepper_handles[handle_index]) == STEPPER_DIR_FORWARD
+  );
+
+  // out 25, back 30, then round to the first pair again
+  for (i=0;i<55;i++) {
+    _ticksToNextStep(stepper_handles[handle_index]);
+  }
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 0);
+  TEST_ASSERT(stepper_getSequenceIndex(stepper_handles[handle_index]) == 0);
+  TEST_ASSERT(stepper_getDesiredPos1(stepper_handles[handle_index]) == 10);
+}
+
+void test_setEnables_returns_error_when_handle_invalid(void)
+{
+  stepper_descriptor_t handles[] = {0, 3};
+  _makeStepper(0);
+
+  TEST_ASSERT(
+    stepper_setEnables(handles, 2, 0x03) == STEPPER_ERR_HANDLE_INVALID
+  );
+  handles[1] = 0;
+  TEST_ASSERT(
+    stepper_setEnables(handles, 2, 0x03) == STEPPER_ERR_HANDLE_INVALID
+  );
+  TEST_ASSERT(stepper_getStatus(0) == STEPPER_STATUS_DISABLED);
+}
+
+void test_setDirs_sets_each_stepper_and_counts_reversals(void)
+{
+  _makeStepper(0);
+  _makeStepper(1);
+  stepper_setBacklash(stepper_handles[1], 2);
+
+  TEST_ASSERT(
+    stepper_setDirs(stepper_handles, 2, 0x02) == STEPPER_ERR_NONE
+  );
+
+  // both steppers share dir_port and dir_pin here, the last one wins
+  TEST_ASSERT(stepper_getDir(stepper_handles[0]) == STEPPER_DIR_FORWARD);
+  TEST_ASSERT(stepper_getDir(stepper_handles[1]) == STEPPER_DIR_REVERSE);
+  TEST_ASSERT(dir_port & (1 << dir_pin));
+  TEST_ASSERT(stepper_getBacklashPending(stepper_handles[1]) == 2);
+}
+
+void test_setIdle_returns_error_when_option_invalid(void)
+{
+  uint8_t handle_index = 0;
+  _makeStepper(handle_index);
+
+  TEST_ASSERT(
+    stepper_setIdle(3, STEPPER_IDLE_DISABLE, 10, 0)
+    == STEPPER_ERR_HANDLE_INVALID
+  );
+  // reducing needs somewhere to write the current
+  TEST_ASSERT(
+    stepper_setIdle(stepper_handles[handle_index], STEPPER_IDLE_REDUCE, 10, 0)
+    == STEPPER_ERR_OPTION_INVALID
+  );
+  TEST_ASSERT(
+    stepper_setIdle(stepper_handles[handle_index], (stepper_idle_t)3, 10, 0)
+    == STEPPER_ERR_OPTION_INVALID
+  );
+}
+
+void test_stepEngage_disables_idle_driver_and_wakes_it_to_step(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t i;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setIdle(stepper_handles[handle_index], STEPPER_IDLE_DISABLE, 3, 2);
+
+  for (i=0;i<3;i++) {
+    stepper_stepEngage(stepper_handles[handle_index]);
+  }
+  TEST_ASSERT((enable_port & (1 << enable_pin)) == 0);
+  stepper_stepEngage(stepper_handles[handle_index]);
+  TEST_ASSERT(enable_port & (1 << enable_pin));
+  TEST_ASSERT(
+    stepper_getIdle(stepper_handles[handle_index]) == STEPPER_IDLE_DISABLE
+  );
+  TEST_ASSERT(
+    stepper_getStatus(stepper_handles[handle_index]) == STEPPER_STATUS_ENABLED
+  );
+
+  // switched back on at once, then 2 ticks to wake before the step
+  stepper_setPos(stepper_handles[handle_index], 1, 0);
+  stepper_stepEngage(stepper_handles[handle_index]);
+  TEST_ASSERT((enable_port & (1 << enable_pin)) == 0);
+  TEST_ASSERT(
+    stepper_getIdle(stepper_handles[handle_index]) == STEPPER_IDLE_NONE
+  );
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 2);
+}
+
+void test_stepEngage_reduces_idle_current(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t current = 0;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  TEST_ASSERT(
+    stepper_setCurrentControl(stepper_handles[handle_index], &current, 0xff,
+      200, 80)
+    == STEPPER_ERR_NONE
+  );
+  TEST_ASSERT(current == 200);
+  stepper_setIdle(stepper_handles[handle_index], STEPPER_IDLE_REDUCE, 0, 0);
+
+  stepper_stepEngage(stepper_handles[handle_index]);
+  TEST_ASSERT(current == 80);
+  TEST_ASSERT((enable_port & (1 << enable_pin)) == 0);
+
+  stepper_setPos(stepper_handles[handle_index], 1, 0);
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 1);
+  TEST_ASSERT(current == 200);
+}
+
+void test_disable_keeps_idle_driver_off_when_idle_settings_change(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t current = 0;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setIdle(stepper_handles[handle_index], STEPPER_IDLE_DISABLE, 0, 0);
+  stepper_stepEngage(stepper_handles[handle_index]);
+  TEST_ASSERT(
+    stepper_getIdle(stepper_handles[handle_index]) == STEPPER_IDLE_DISABLE
+  );
+
+  stepper_disable(stepper_handles[handle_index]);
+  TEST_ASSERT(
+    stepper_getIdle(stepper_handles[handle_index]) == STEPPER_IDLE_NONE
+  );
+  stepper_setIdle(stepper_handles[handle_index], STEPPER_IDLE_DISABLE, 5, 0);
+  stepper_setCurrentControl(stepper_handles[handle_index], &current, 0xff,
+    200, 80);
+  TEST_ASSERT(enable_port & (1 << enable_pin));
+  TEST_ASSERT(
+    stepper_getStatus(stepper_handles[handle_index]) == STEPPER_STATUS_DISABLED
+  );
+}
+
+void test_setEnables_restores_run_current_when_disabling_reduced_driver(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t current = 0;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setCurrentControl(stepper_handles[handle_index], &current, 0xff,
+    200, 80);
+  stepper_setIdle(stepper_handles[handle_index], STEPPER_IDLE_REDUCE, 0, 0);
+  stepper_stepEngage(stepper_handles[handle_index]);
+  TEST_ASSERT(current == 80);
+
+  stepper_setEnables(stepper_handles, 1, 0);
+  TEST_ASSERT(current == 200);
+  stepper_setIdle(stepper_handles[handle_index], STEPPER_IDLE_REDUCE, 5, 0);
+  TEST_ASSERT(enable_port & (1 << enable_pin));
+}
+
+void test_setDir_waits_for_hold_and_setup_ticks_around_steps(void)
+{
+  uint8_t handle_index = 0;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  TEST_ASSERT(stepper_setDirTiming(3, 2, 1) == STEPPER_ERR_HANDLE_INVALID);
+  stepper_setDirTiming(stepper_handles[handle_index], 2, 1);
+  stepper_setPos(stepper_handles[handle_index], 1, 0);
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 1);
+
+  // the pin is written on the tick after the step, the step 2 ticks later
+  stepper_setPos(stepper_handles[handle_index], 0, 0);
+  stepper_setDir(stepper_handles[handle_index], STEPPER_DIR_REVERSE);
+  TEST_ASSERT((dir_port & (1 << dir_pin)) == 0);
+  stepper_stepEngage(stepper_handles[handle_index]);
+  TEST_ASSERT(dir_port & (1 << dir_pin));
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 1);
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 2);
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 0);
+
+  // reversing and back again before the tick leaves nothing to wait for
+  stepper_setPos(stepper_handles[handle_index], 199, 0);
+  stepper_setDir(stepper_handles[handle_index], STEPPER_DIR_FORWARD);
+  stepper_setDir(stepper_handles[handle_index], STEPPER_DIR_REVERSE);
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 1);
+}
+
+void test_stepRelease_oscillate_turnaround_waits_for_dir_timing(void)
+{
+  uint8_t handle_index = 0;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setMode(stepper_handles[handle_index], STEPPER_MODE_OSCILLATE);
+  stepper_setDirTiming(stepper_handles[handle_index], 1, 1);
+  stepper_setPos(stepper_handles[handle_index], 2, 0);
+
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 1);
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 1);
+  TEST_ASSERT(
+    stepper_getDir(stepper_handles[handle_index]) == STEPPER_DIR_REVERSE
+  );
+  TEST_ASSERT((dir_port & (1 << dir_pin)) == 0);
+  TEST_ASSERT(_ticksToNextStep(stepper_handles[handle_index]) == 2);
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 1);
+  TEST_ASSERT(dir_port & (1 << dir_pin));
+}
+
+void test_step_returns_error_when_handle_invalid(void)
+{
+  stepper_descriptor_t handles[] = {0, 3};
+  stepper_descriptor_t repeated[] = {0, 0};
+  _makeStepper(0);
+  stepper_enable(0);
+  stepper_setPos(0, 1, 0);
+
+  TEST_ASSERT(stepper_step(handles, 2) == STEPPER_ERR_HANDLE_INVALID);
+  TEST_ASSERT(stepper_step(repeated, 2) == STEPPER_ERR_HANDLE_INVALID);
+  TEST_ASSERT(stepper_getPos(0) == 0);
+}
+
+void test_step_holds_each_pulse_for_one_call(void)
+{
+  uint8_t handle_index = 0;
+
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setPos(stepper_handles[handle_index], 2, 0);
+
+  TEST_ASSERT(stepper_step(stepper_handles, 1) == STEPPER_ERR_NONE);
+  TEST_ASSERT(step_port & (1 << step_pin));
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 1);
+
+  stepper_step(stepper_handles, 1);
+  TEST_ASSERT((step_port & (1 << step_pin)) == 0);
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 1);
+
+  stepper_step(stepper_handles, 1);
+  TEST_ASSERT(step_port & (1 << step_pin));
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 2);
+
+  // arrived, so the line only comes down
+  stepper_step(stepper_handles, 1);
+  stepper_step(stepper_handles, 1);
+  TEST_ASSERT((step_port & (1 << step_pin)) == 0);
+  TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == 2);
+}
+
+void test_step_matches_engage_then_release(void)
+{
+  uint8_t handle_index = 0;
+  uint8_t pos[150];
+  stepper_dir_t dir[150];
+  uint8_t reversals = 0;
+  uint8_t was_high = 0;
+  uint8_t high;
+  uint8_t i;
+
+  // each engage and release is a tick of the two call sequence
+  _makeOscillator(handle_index);
+  for (i=0;i<150;i++) {
+    stepper_stepEngage(stepper_handles[handle_index]);
+    stepper_stepRelease(stepper_handles[handle_index]);
+    pos[i] = stepper_getPos(stepper_handles[handle_index]);
+    dir[i] = stepper_getDir(stepper_handles[handle_index]);
+    if (i > 0 && dir[i] != dir[i - 1]) {
+      reversals++;
+    }
+  }
+  TEST_ASSERT(reversals >= 4);
+
+  stepper_destruct(stepper_handles[handle_index]);
+  _makeOscillator(handle_index);
+
+  // and with one call it is whichever call leaves the line low
+  i = 0;
+  while (i < 150) {
+    stepper_step(stepper_handles, 1);
+    high = (step_port & (1 << step_pin)) != 0;
+    TEST_ASSERT(!(high && was_high));
+    if (!high) {
+      TEST_ASSERT(stepper_getPos(stepper_handles[handle_index]) == pos[i]);
+      TEST_ASSERT(stepper_getDir(stepper_handles[handle_index]) == dir[i]);
+      i++;
+    }
+    was_high = high;
+  }
+}
 
 /*******************************************************************************
 * Private Function Definitions
@@ -628,3 +1244,28 @@ stepper_err_t _makeStepper(uint8_t handle_index) {
 
   return stepper_construct(config, &stepper_handles[handle_index]);
 }
+
+// oscillating between 3 and 12 with everything that holds steps back
+static void _makeOscillator(uint8_t handle_index) {
+  _makeStepper(handle_index);
+  stepper_enable(stepper_handles[handle_index]);
+  stepper_setMode(stepper_handles[handle_index], STEPPER_MODE_OSCILLATE);
+  stepper_setTurnaround(stepper_handles[handle_index], 4, 3);
+  stepper_setBacklash(stepper_handles[handle_index], 2);
+  stepper_setDirTiming(stepper_handles[handle_index], 1, 1);
+  stepper_setPos(stepper_handles[handle_index], 12, 3);
+}
+
+// runs engage and release until the position moves, returns the ticks taken
+static uint8_t _ticksToNextStep(stepper_descriptor_t handle) {
+  uint8_t pos = stepper_getPos(handle);
+  uint8_t ticks = 0;
+
+  while (stepper_getPos(handle) == pos && ticks < 255) {
+    stepper_stepEngage(handle);
+    stepper_stepRelease(handle);
+    ticks++;
+  }
+
+  return ticks;
+}